@@ -10,6 +10,7 @@
 #include <random>
 #include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
 
 using namespace std;
@@ -29,15 +30,28 @@ static void show_usage( const char* argv0, const char* msg )
        << "   -a <addr>       Set source address (client mode only)           " << LOCAL_ADDRESS_DFLT << "\n"
        << "   -s <port>       Set source port (client mode only)              (random)\n\n"
 
-       << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
-       << "\n\n"
+       << "   -w <winsz>      Use a receive window of <winsz> bytes (k/M ok)  " << TCPConfig::DEFAULT_CAPACITY
+       << "\n"
+       << "   -W <bufsz>      Use a send buffer of <bufsz> bytes (k/M ok)     " << TCPConfig::DEFAULT_CAPACITY
+       << "\n"
+       << "   -n              Don't offer window scaling (max window 64 KiB)  (window scaling)\n"
+       << "   -m <mss>        Largest segment payload, e.g. MTU - 40          " << TCPConfig::MAX_PAYLOAD_SIZE
+       << "\n"
+       << "   -P              Probe the path MTU, from " << TCPConfig::MAX_PAYLOAD_SIZE
+       << " up to the MSS     (no probing)\n\n"
 
-       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+       << "   -r <min>        Adapt the timeout to the RTT, at least <min> ms (fixed timeout)\n\n"
+
+       << "   -c <algorithm>  Congestion control: none, reno, newreno, cubic  none\n"
+       << "   -p <rate>       Pace sending at <rate> bytes/s (0: cwnd/RTT)    (no pacing)\n\n"
 
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
-       << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n\n"
+       << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n"
+       << "   -Lb <rate>      Uplink bottleneck of <rate> bytes/s             (no bottleneck)\n"
+       << "   -Lq <segs>      Bottleneck queue depth, in segments             16\n\n"
 
        << "   -h              Show this message.\n\n";
 
@@ -47,6 +61,23 @@ static void show_usage( const char* argv0, const char* msg )
   cout << endl;
 }
 
+// A byte count, optionally with a k (KiB) or M (MiB) suffix
+static size_t parse_size( const char* arg )
+{
+  char* end = nullptr;
+  const size_t value = strtoull( arg, &end, 0 );
+  switch ( *end ) {
+    case 'k':
+    case 'K':
+      return value << 10;
+    case 'm':
+    case 'M':
+      return value << 20;
+    default:
+      return value;
+  }
+}
+
 static void check_argc( const span<char*>& args, size_t curr, const char* err )
 {
   if ( curr + 3 >= args.size() ) {
@@ -85,14 +116,61 @@ static tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const sp
 
     } else if ( strncmp( "-w", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -w requires one argument." );
-      c_fsm.recv_capacity = strtol( args[curr + 1], nullptr, 0 );
+      c_fsm.recv_capacity = parse_size( args[curr + 1] );
+      curr += 2;
+
+    } else if ( strncmp( "-W", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -W requires one argument." );
+      c_fsm.send_capacity = parse_size( args[curr + 1] );
+      curr += 2;
+
+    } else if ( strncmp( "-n", args[curr], 3 ) == 0 ) {
+      c_fsm.window_scaling = false;
+      curr += 1;
+
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -m requires one argument." );
+      c_fsm.mss = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-P", args[curr], 3 ) == 0 ) {
+      c_fsm.mtu_probing = true;
+      curr += 1;
+
     } else if ( strncmp( "-t", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-r", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -r requires one argument." );
+      c_fsm.adaptive_rto = true;
+      c_fsm.rto_min = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-c", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -c requires one argument." );
+      const string_view algorithm { args[curr + 1] };
+      if ( algorithm == "none" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::None;
+      } else if ( algorithm == "reno" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::Reno;
+      } else if ( algorithm == "newreno" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::NewReno;
+      } else if ( algorithm == "cubic" ) {
+        c_fsm.congestion_control = TCPConfig::CongestionControl::Cubic;
+      } else {
+        show_usage( args[0], "ERROR: unknown congestion control algorithm." );
+        exit( 1 );
+      }
+      curr += 2;
+
+    } else if ( strncmp( "-p", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -p requires one argument." );
+      c_fsm.pacing = true;
+      c_fsm.pacing_rate = strtoull( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -114,6 +192,16 @@ static tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const sp
         = static_cast<LossRateDnT>( static_cast<float>( numeric_limits<LossRateDnT>::max() ) * lossrate );
       curr += 2;
 
+    } else if ( strncmp( "-Lb", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -Lb requires one argument." );
+      c_filt.bottleneck_rate = strtoull( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-Lq", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -Lq requires one argument." );
+      c_filt.bottleneck_queue = strtoull( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
     } else if ( strncmp( "-h", args[curr], 3 ) == 0 ) {
       show_usage( args[0], nullptr );
       exit( 0 );
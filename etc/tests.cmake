@@ -11,6 +11,11 @@ macro (ttest name)
   set_property(TEST ${name} PROPERTY FIXTURES_REQUIRED compile)
 endmacro (ttest)
 
+macro (tsantest name)
+  add_test(NAME ${name} COMMAND "${name}_tsan")
+  set_property(TEST ${name} PROPERTY FIXTURES_REQUIRED compile)
+endmacro (tsantest)
+
 set_property(TEST ${compile_name} PROPERTY TIMEOUT -1)
 set_tests_properties(${compile_name} PROPERTIES FIXTURES_SETUP compile)
 
@@ -23,6 +28,14 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_buffer)
+
+ttest(byte_stream_basics_chunked)
+ttest(byte_stream_capacity_chunked)
+ttest(byte_stream_one_write_chunked)
+ttest(byte_stream_two_writes_chunked)
+ttest(byte_stream_many_writes_chunked)
+ttest(byte_stream_stress_test_chunked)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -32,6 +45,14 @@ ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
 
+ttest(reassembler_single_buffered)
+ttest(reassembler_cap_buffered)
+ttest(reassembler_seq_buffered)
+ttest(reassembler_dup_buffered)
+ttest(reassembler_holes_buffered)
+ttest(reassembler_overlapping_buffered)
+ttest(reassembler_win_buffered)
+
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
 ttest(wrapping_integers_unwrap)
@@ -45,6 +66,9 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(recv_window_scale)
+ttest(recv_timestamps)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,24 +77,41 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_sack)
+ttest(send_fast_retx)
+ttest(send_rto)
+ttest(send_pacing)
+ttest(send_mtu_probe)
+
+ttest(tcp_peer_options)
+ttest(tcp_peer_delayed_ack)
+ttest(tcp_peer_autotuning)
+ttest(tcp_peer_dup_ack)
 
 ttest(net_interface)
 
 ttest(router)
 
-add_custom_target (check0 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R 'webget|^byte_stream_')
+ttest(timer_wheel)
+ttest(checksum)
+ttest(header_layout)
+
+tsantest(spsc_byte_stream)
+
+add_custom_target (check0 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R 'webget|^byte_stream_|^spsc_byte_stream')
 
 add_custom_target (check_webget COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --timeout 12 -R 'webget')
 
-add_custom_target (check1 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_')
+add_custom_target (check1 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^spsc_byte_stream|^reassembler_')
 
-add_custom_target (check2 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv')
+add_custom_target (check2 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^spsc_byte_stream|^reassembler_|^wrapping|^recv')
 
-add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^send')
+add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^spsc_byte_stream|^reassembler_|^wrapping|^recv|^send|^tcp_peer_|^timer_wheel|^checksum|^header_layout')
 
-add_custom_target (check4 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^net_interface')
+add_custom_target (check4 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^net_interface|^timer_wheel|^checksum|^header_layout')
 
-add_custom_target (check5 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^net_interface|^router')
+add_custom_target (check5 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^net_interface|^router|^timer_wheel|^checksum|^header_layout')
 
 ###
 
@@ -90,3 +131,9 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(reassembler_scenarios_speed_test)
+stest(spsc_byte_stream_speed_test)
+stest(tcp_throughput_speed_test)
+stest(timer_wheel_speed_test)
+stest(checksum_speed_test)
+stest(parser_speed_test)
@@ -1,20 +1,76 @@
+#include <algorithm>
 #include <stdexcept>
 
 #include "byte_stream.hh"
+#include "checksum.hh"
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+ByteStream::ByteStream( uint64_t capacity, Storage storage )
+  : capacity_( capacity ), storage_( storage ), ring_( storage == Storage::Ring ? capacity : 0, '\0' )
+{}
 
 void Writer::push( string data )
 {
   // Your code here.
-  if ( error_ || is_closed() || data.empty() ) {
+  if ( error_ || is_closed() || data.empty() || available_capacity() == 0 ) {
     return;
   }
-  const size_t len = min( data.length(), available_capacity() );
-  queue_ += data.substr( 0, len ); // 往 queue 里写入
-  pushed_len_ += len;              // 已经写入多少个字节
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+
+  if ( storage_ == Storage::Chunked ) {
+    data.resize( len ); // only shrinks (and so never copies) when the push exceeded available capacity
+    chunks_.emplace_back( move( data ) );
+    pushed_len_ += len; // 已经写入多少个字节
+    return;
+  }
+
+  write_reserved( 0, string_view { data }.substr( 0, len ) );
+  commit( len );
+}
+
+void Writer::write_reserved( uint64_t offset, string_view data )
+{
+  if ( storage_ != Storage::Ring ) {
+    throw runtime_error( "Writer::write_reserved() requires Ring storage" );
+  }
+  if ( offset + data.size() > available_capacity() ) {
+    throw runtime_error( "Writer::write_reserved() beyond available capacity" );
+  }
+  if ( data.empty() ) {
+    return;
+  }
+  const uint64_t tail = ( pushed_len_ + offset ) % capacity_;                 // 写指针在环中的位置
+  const uint64_t first_part = min<uint64_t>( data.size(), capacity_ - tail ); // 到环尾为止能写多少
+  copy_n( data.data(), first_part, ring_.data() + tail );
+  copy_n( data.data() + first_part, data.size() - first_part, ring_.data() ); // 绕回环首
+}
+
+void Writer::commit( uint64_t len )
+{
+  if ( error_ || is_closed() ) {
+    return;
+  }
+  pushed_len_ += min( len, available_capacity() ); // 已经写入多少个字节
+}
+
+void Writer::set_capacity( uint64_t capacity )
+{
+  capacity = max( capacity, pushed_len_ - released_len_ ); // 不能丢掉已经写入的字节
+  if ( storage_ == Storage::Ring and capacity != capacity_ ) {
+    // 按流中的位置搬到新环里：保留的、缓冲的，以及 write_reserved() 写在空闲空间里、新环还装得下的字节
+    string ring( capacity, '\0' );
+    const uint64_t keep = min( capacity, capacity_ );
+    for ( uint64_t moved = 0; moved < keep; ) {
+      const uint64_t from = ( released_len_ + moved ) % capacity_;
+      const uint64_t to = ( released_len_ + moved ) % capacity;
+      const uint64_t len = min( { keep - moved, capacity_ - from, capacity - to } );
+      copy_n( ring_.data() + from, len, ring.data() + to );
+      moved += len;
+    }
+    ring_ = move( ring );
+  }
+  capacity_ = capacity;
 }
 
 void Writer::close()
@@ -38,7 +94,7 @@ bool Writer::is_closed() const
 uint64_t Writer::available_capacity() const
 {
   // Your code here.
-  return capacity_ - pushed_len_ + popped_len_;
+  return capacity_ - pushed_len_ + released_len_;
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -50,13 +106,52 @@ uint64_t Writer::bytes_pushed() const
 string_view Reader::peek() const
 {
   // Your code here.
-  return queue_;
+  // Only the contiguous part up to the wrap point; the caller peeks again after popping it.
+  if ( bytes_buffered() == 0 ) {
+    return {};
+  }
+  if ( storage_ == Storage::Chunked ) {
+    return std::string_view { chunks_.front() }.substr( chunk_skip_ );
+  }
+  const uint64_t head = popped_len_ % capacity_;
+  return string_view { ring_ }.substr( head, min( bytes_buffered(), capacity_ - head ) );
+}
+
+Buffer Reader::peek_buffer() const
+{
+  if ( storage_ == Storage::Chunked and bytes_buffered() > 0 ) {
+    return chunks_.front().substr( chunk_skip_ ); // 共享 chunk 的存储，不复制
+  }
+  return string { peek() };
+}
+
+vector<string_view> Reader::peek_iov() const
+{
+  vector<string_view> regions;
+  if ( bytes_buffered() == 0 ) {
+    return regions;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    regions.reserve( chunks_.size() );
+    regions.push_back( peek() );
+    for ( auto it = next( chunks_.begin() ); it != chunks_.end(); ++it ) {
+      regions.emplace_back( *it );
+    }
+    return regions;
+  }
+
+  regions.push_back( peek() );
+  if ( regions.front().size() < bytes_buffered() ) { // 绕回环首的部分
+    regions.emplace_back( ring_.data(), bytes_buffered() - regions.front().size() );
+  }
+  return regions;
 }
 
 bool Reader::is_finished() const
 {
   // Your code here.
-  return closed_ && queue_.empty();
+  return closed_ && bytes_buffered() == 0;
 }
 
 bool Reader::has_error() const
@@ -68,12 +163,98 @@ bool Reader::has_error() const
 void Reader::pop( uint64_t len )
 {
   // Your code here.
-  if ( queue_.empty() ) {
-    return;
+  // Ring: O(1), just advance the read index; the bytes are overwritten by later pushes.
+  len = min( len, bytes_buffered() );
+  popped_len_ += len; // 已经读出多少字节
+  if ( !retain_ ) {
+    released_len_ = popped_len_;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    while ( len > 0 ) {
+      const uint64_t n = min( len, chunks_.front().size() - chunk_skip_ );
+      if ( retain_ ) { // 保留的部分只是 chunk 的切片，不复制
+        retained_.push_back( chunks_.front().substr( chunk_skip_, n ) );
+      }
+      chunk_skip_ += n;
+      len -= n;
+      if ( chunk_skip_ == chunks_.front().size() ) { // 整块读完就丢掉
+        chunk_skip_ = 0;
+        chunks_.pop_front();
+      }
+    }
+  }
+}
+
+void Reader::retain( bool enable )
+{
+  retain_ = enable;
+  if ( !retain_ ) {
+    release( bytes_retained() );
+  }
+}
+
+void Reader::release( uint64_t len )
+{
+  len = min( len, bytes_retained() );
+  released_len_ += len;
+
+  if ( storage_ == Storage::Chunked ) {
+    retained_skip_ += len;
+    while ( !retained_.empty() && retained_skip_ >= retained_.front().size() ) {
+      retained_skip_ -= retained_.front().size();
+      retained_.pop_front();
+    }
   }
-  len = std::min( len, queue_.size() );
-  queue_.erase( queue_.begin(), queue_.begin() + len ); // 模拟读出，其实是擦除
-  popped_len_ += len;                                   // 已经读出多少字节
+}
+
+Buffer Reader::peek_retained( uint64_t offset, uint64_t len, InternetChecksum* checksum ) const
+{
+  offset = min( offset, bytes_retained() );
+  len = min( len, bytes_retained() - offset );
+  if ( len == 0 ) {
+    return {};
+  }
+
+  // 复制的同时累加校验和 (只读一遍)
+  const auto copy = [checksum]( char* dst, string_view piece ) {
+    if ( checksum ) {
+      checksum->copy_and_add( dst, piece );
+    } else {
+      copy_n( piece.data(), piece.size(), dst );
+    }
+  };
+
+  if ( storage_ == Storage::Ring ) {
+    const uint64_t head = ( released_len_ + offset ) % capacity_;
+    const uint64_t first_part = min( len, capacity_ - head );
+    string out( len, '\0' );
+    copy( out.data(), string_view { ring_ }.substr( head, first_part ) );
+    copy( out.data() + first_part, string_view { ring_ }.substr( 0, len - first_part ) ); // 绕回环首的部分
+    return out;
+  }
+
+  // Chunked: find the slice that holds the first byte
+  offset += retained_skip_;
+  auto it = retained_.begin();
+  while ( offset >= it->size() ) {
+    offset -= it->size();
+    ++it;
+  }
+  if ( offset + len <= it->size() ) {
+    Buffer slice = it->substr( offset, len );
+    if ( checksum ) {
+      checksum->add( slice );
+    }
+    return slice;
+  }
+  string out( len, '\0' );
+  for ( uint64_t copied = 0; copied < len; ++it, offset = 0 ) {
+    const string_view piece = string_view { *it }.substr( offset, len - copied );
+    copy( out.data() + copied, piece );
+    copied += piece.size();
+  }
+  return out;
 }
 
 uint64_t Reader::bytes_buffered() const
@@ -87,3 +268,8 @@ uint64_t Reader::bytes_popped() const
   // Your code here.
   return popped_len_;
 }
+
+uint64_t Reader::bytes_retained() const
+{
+  return popped_len_ - released_len_;
+}
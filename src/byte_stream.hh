@@ -1,26 +1,55 @@
 #pragma once
 
+#include "buffer.hh"
+
+#include <cstdint>
+#include <deque>
 #include <queue>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
+class InternetChecksum;
 class Reader;
 class Writer;
 
 class ByteStream
 {
+public:
+  /*
+   * How the buffered bytes are stored:
+   *   Ring:    copied into a ring of `capacity` bytes allocated once at construction.
+   *   Chunked: each pushed string is kept as its own chunk (moved in, not copied);
+   *            a push is only copied/truncated when it exceeds the available capacity.
+   */
+  enum class Storage : uint8_t
+  {
+    Ring,
+    Chunked
+  };
+
 protected:
   uint64_t capacity_;
+  Storage storage_;
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
-  std::string queue_ {};
-  uint64_t pushed_len_ { 0 }; // 入
-  uint64_t popped_len_ { 0 }; // 出
-  bool closed_ { false };     // 关闭
-  bool error_ { false };      // 错误
+  std::string ring_;               // Ring: ring buffer of capacity_ bytes (reallocated by set_capacity)
+  std::deque<Buffer> chunks_ {};   // Chunked: pushed strings, in order
+  uint64_t chunk_skip_ { 0 };      // Chunked: bytes already popped from chunks_.front()
+  uint64_t pushed_len_ { 0 };      // 入
+  uint64_t popped_len_ { 0 };      // 出
+  bool retain_ { false };          // popped bytes stay (and use capacity) until released
+  uint64_t released_len_ { 0 };    // 不再保留的字节 (<= popped_len_)
+  std::deque<Buffer> retained_ {}; // Chunked: the retained bytes, as slices of the popped chunks
+  uint64_t retained_skip_ { 0 };   // Chunked: bytes already released from retained_.front()
+  bool closed_ { false };          // 关闭
+  bool error_ { false };           // 错误
 
 public:
-  explicit ByteStream( uint64_t capacity );
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Ring );
+
+  Storage storage() const { return storage_; }
+  uint64_t capacity() const { return capacity_; } // Bytes the stream can hold (buffered and retained)
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -37,6 +66,18 @@ public:
   void close();     // Signal that the stream has reached its ending. Nothing more will be written.
   void set_error(); // Signal that the stream suffered an error.
 
+  // Ring storage only: the free space after the pushed bytes can be written out of order and
+  // published later. write_reserved() copies `data` to `offset` bytes past bytes_pushed() (it must fit
+  // within available_capacity()) without making it readable; commit() then makes the next `len` bytes
+  // readable, as if they had been pushed.
+  void write_reserved( uint64_t offset, std::string_view data );
+  void commit( uint64_t len );
+
+  // Change the capacity, e.g. to right-size a receive buffer. It never drops below the bytes the stream
+  // holds (buffered and retained), and bytes written with write_reserved() are kept as long as they still
+  // fit. Ring storage moves the bytes into a new ring of the new size.
+  void set_capacity( uint64_t capacity );
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now? 当前可用容量
   uint64_t bytes_pushed() const; // Total number of bytes cumulatively pushed to the stream 总共有多少字节被推到流中
@@ -45,14 +86,32 @@ public:
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
+  std::string_view peek() const; // Peek at the next bytes in the buffer (up to the ring wrap / end of chunk)
   void pop( uint64_t len );      // Remove `len` bytes from the buffer 从缓冲区中删除len字节
 
+  // Peek at *all* buffered bytes, as a list of contiguous regions (at most two for Ring storage, one per chunk
+  // for Chunked) suitable for a single writev; pop() the number of bytes actually consumed afterwards.
+  std::vector<std::string_view> peek_iov() const;
+
+  // Retention: after retain( true ), popped bytes stay in the stream, still counting against its capacity, until
+  // release()d -- e.g. the bytes a TCP sender has sent but that are not acknowledged yet.
+  void retain( bool enable );
+  void release( uint64_t len ); // Stop retaining the oldest `len` retained bytes
+  // `len` retained bytes, starting `offset` bytes after the oldest one (a slice if they are contiguous in
+  // Chunked storage, else a copy). If `checksum` is given, the bytes are also added to it, in the same
+  // pass as the copy.
+  Buffer peek_retained( uint64_t offset, uint64_t len, InternetChecksum* checksum = nullptr ) const;
+
+  // The same bytes as peek(), as a Buffer that stays valid after pop(): for Chunked storage it is a slice of
+  // the pushed string (no copy), for Ring storage a copy.
+  Buffer peek_buffer() const;
+
   bool is_finished() const; // Is the stream finished (closed and fully popped)?
   bool has_error() const;   // Has the stream had an error?
 
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
   uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+  uint64_t bytes_retained() const; // Number of bytes popped but not yet released
 };
 
 /*
@@ -60,3 +119,9 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+/*
+ * read: Same, into a Buffer. If the bytes are all in one chunk of a Chunked stream,
+ * `out` is a slice of that chunk and nothing is copied.
+ */
+void read( Reader& reader, uint64_t len, Buffer& out );
@@ -1,5 +1,6 @@
 #include "byte_stream.hh"
 
+#include <algorithm>
 #include <cstdint>
 #include <stdexcept>
 
@@ -24,6 +25,19 @@ void read( Reader& reader, uint64_t len, std::string& out )
   }
 }
 
+void read( Reader& reader, uint64_t len, Buffer& out )
+{
+  len = std::min( len, reader.bytes_buffered() );
+  if ( reader.storage() == ByteStream::Storage::Chunked and reader.peek().size() >= len ) {
+    out = reader.peek_buffer().substr( 0, len );
+    reader.pop( len );
+    return;
+  }
+
+  out = Buffer {};
+  read( reader, len, static_cast<std::string&>( out ) );
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -0,0 +1,214 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+Reno::Reno( uint64_t mss ) : mss_( mss ), cwnd_( initial_window( mss ) ) {}
+
+uint64_t Reno::initial_window( uint64_t mss )
+{
+  return min( 10 * mss, max<uint64_t>( 2 * mss, 14600 ) ); // RFC 6928
+}
+
+void Reno::set_mss( uint64_t mss )
+{
+  if ( cwnd_ == initial_window( mss_ ) and ssthresh_ == UINT64_MAX ) { // 还没有增长或减小过
+    cwnd_ = initial_window( mss );
+  }
+  mss_ = mss;
+}
+
+void Reno::grow( uint64_t acked )
+{
+  if ( cwnd_ < ssthresh_ ) { // 慢启动：每个 ACK 最多增加一个 MSS
+    cwnd_ += min( acked, mss_ );
+    return;
+  }
+  // 拥塞避免：每确认一个窗口的数据增加一个 MSS
+  acked_in_avoidance_ += acked;
+  if ( acked_in_avoidance_ >= cwnd_ ) {
+    acked_in_avoidance_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void Reno::reduce( uint64_t in_flight )
+{
+  ssthresh_ = max( in_flight / 2, 2 * mss_ );
+  acked_in_avoidance_ = 0;
+}
+
+void Reno::on_ack( uint64_t acked, uint64_t /* ackno */, uint64_t /* now_ms */ )
+{
+  if ( in_recovery_ ) { // the first new ACK ends fast recovery, deflating the window
+    in_recovery_ = false;
+    cwnd_ = ssthresh_;
+    return;
+  }
+  grow( acked );
+}
+
+void Reno::on_timeout( uint64_t in_flight, uint64_t /* now_ms */ )
+{
+  reduce( in_flight );
+  cwnd_ = mss_;
+  in_recovery_ = false;
+}
+
+void Reno::on_fast_retransmit( uint64_t in_flight, uint64_t recover, uint64_t /* now_ms */, bool sack )
+{
+  if ( in_recovery_ ) {
+    return;
+  }
+  reduce( in_flight );
+  // the three duplicate ACKs each mean a segment has left the network; with SACK the pipe already says so
+  cwnd_ = ssthresh_ + ( sack ? 0 : 3 * mss_ );
+  in_recovery_ = true;
+  sack_recovery_ = sack;
+  recover_ = recover;
+}
+
+void Reno::on_duplicate_ack()
+{
+  if ( in_recovery_ and not sack_recovery_ ) {
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_ack( uint64_t acked, uint64_t ackno, uint64_t now_ms )
+{
+  if ( not in_recovery_ or ackno >= recover_ ) {
+    Reno::on_ack( acked, ackno, now_ms );
+    return;
+  }
+  if ( sack_recovery_ ) { // the window was never inflated: the pipe shrinks by itself
+    return;
+  }
+  // partial ACK: deflate by the amount acked, and add back one MSS if at least that much was acked
+  cwnd_ -= min( cwnd_, acked );
+  if ( acked >= mss_ ) {
+    cwnd_ += mss_;
+  }
+  cwnd_ = max( cwnd_, mss_ );
+}
+
+void Cubic::reduce_cubic( uint64_t now_ms )
+{
+  const double cwnd_segments = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+  // fast convergence: a flow whose w_max keeps shrinking releases bandwidth sooner
+  w_max_ = cwnd_segments < w_max_ ? cwnd_segments * ( 1 + BETA ) / 2 : cwnd_segments;
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), 2 * mss_ );
+  acked_in_avoidance_ = 0;
+  epoch_started_ = false;
+  epoch_start_ms_ = now_ms;
+}
+
+void Cubic::on_ack( uint64_t acked, uint64_t ackno, uint64_t now_ms )
+{
+  if ( in_recovery_ or cwnd_ < ssthresh_ ) {
+    NewReno::on_ack( acked, ackno, now_ms );
+    return;
+  }
+
+  const double cwnd_segments = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+  if ( not epoch_started_ ) {
+    epoch_started_ = true;
+    epoch_start_ms_ = now_ms;
+    k_ = w_max_ > cwnd_segments ? cbrt( ( w_max_ - cwnd_segments ) / C ) : 0;
+    w_max_ = max( w_max_, cwnd_segments );
+    w_est_ = cwnd_segments;
+  }
+
+  const double t = static_cast<double>( now_ms - epoch_start_ms_ ) / 1000;
+  const double w_cubic = C * pow( t - k_, 3 ) + w_max_;
+  const double segments_acked = static_cast<double>( acked ) / static_cast<double>( mss_ );
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * segments_acked / cwnd_segments;
+
+  const double target = min( max( w_cubic, w_est_ ), 1.5 * cwnd_segments );
+  if ( target > cwnd_segments ) {
+    // (target - cwnd) / cwnd segments per segment acked, carried over in acked_in_avoidance_ as bytes
+    acked_in_avoidance_ += static_cast<uint64_t>( ( target - cwnd_segments ) / cwnd_segments
+                                                  * static_cast<double>( acked ) * static_cast<double>( mss_ ) );
+    cwnd_ += acked_in_avoidance_ / mss_;
+    acked_in_avoidance_ %= mss_;
+  }
+}
+
+void Cubic::on_timeout( uint64_t in_flight, uint64_t now_ms )
+{
+  reduce_cubic( now_ms );
+  const auto ssthresh = ssthresh_;
+  NewReno::on_timeout( in_flight, now_ms );
+  ssthresh_ = ssthresh; // CUBIC reduces by BETA, not to half the flight size
+}
+
+void Cubic::on_fast_retransmit( uint64_t in_flight, uint64_t recover, uint64_t now_ms, bool sack )
+{
+  if ( in_recovery_ ) {
+    return;
+  }
+  reduce_cubic( now_ms );
+  const auto ssthresh = ssthresh_;
+  NewReno::on_fast_retransmit( in_flight, recover, now_ms, sack );
+  ssthresh_ = ssthresh; // CUBIC reduces by BETA, not to half the flight size
+  cwnd_ = ssthresh_ + ( sack ? 0 : 3 * mss_ );
+}
+
+CongestionController::CongestionController( TCPConfig::CongestionControl algorithm, uint64_t mss ) : algorithm_()
+{
+  switch ( algorithm ) {
+    case TCPConfig::CongestionControl::None:
+      break;
+    case TCPConfig::CongestionControl::Reno:
+      algorithm_.emplace<Reno>( mss );
+      break;
+    case TCPConfig::CongestionControl::NewReno:
+      algorithm_.emplace<NewReno>( mss );
+      break;
+    case TCPConfig::CongestionControl::Cubic:
+      algorithm_.emplace<Cubic>( mss );
+      break;
+  }
+}
+
+uint64_t CongestionController::cwnd() const
+{
+  return visit( []( const auto& a ) { return a.cwnd(); }, algorithm_ );
+}
+
+uint64_t CongestionController::ssthresh() const
+{
+  return visit( []( const auto& a ) { return a.ssthresh(); }, algorithm_ );
+}
+
+void CongestionController::on_ack( uint64_t acked, uint64_t ackno, uint64_t now_ms )
+{
+  visit( [&]( auto& a ) { a.on_ack( acked, ackno, now_ms ); }, algorithm_ );
+}
+
+void CongestionController::on_timeout( uint64_t in_flight, uint64_t now_ms )
+{
+  visit( [&]( auto& a ) { a.on_timeout( in_flight, now_ms ); }, algorithm_ );
+}
+
+void CongestionController::on_fast_retransmit( uint64_t in_flight, uint64_t recover, uint64_t now_ms, bool sack )
+{
+  visit( [&]( auto& a ) { a.on_fast_retransmit( in_flight, recover, now_ms, sack ); }, algorithm_ );
+}
+
+void CongestionController::on_duplicate_ack()
+{
+  visit( []( auto& a ) { a.on_duplicate_ack(); }, algorithm_ );
+}
+
+bool CongestionController::in_recovery() const
+{
+  return visit( []( const auto& a ) { return a.in_recovery(); }, algorithm_ );
+}
+
+void CongestionController::set_mss( uint64_t mss )
+{
+  visit( [&]( auto& a ) { a.set_mss( mss ); }, algorithm_ );
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "tcp_config.hh"
+
+#include <cstdint>
+#include <variant>
+
+/*
+ * Congestion window state machines for the TCPSender. All of them count in sequence numbers
+ * and share one interface, which the sender calls from push/receive/tick:
+ *
+ *   cwnd(), ssthresh()           the current congestion window and slow-start threshold
+ *   on_ack( acked, ackno, now )  `acked` > 0 new sequence numbers were cumulatively acknowledged
+ *   on_timeout( in_flight, now ) the retransmission timer expired (RFC 5681 3.1)
+ *   on_fast_retransmit( in_flight, recover, now, sack )
+ *                                a loss was inferred from duplicate ACKs; `recover` is the end of
+ *                                the data sent so far, and recovery lasts until it is acknowledged.
+ *                                With `sack` the sender subtracts SACKed data from the pipe itself
+ *                                (RFC 6675), so the window is not inflated for the duplicate ACKs
+ *   on_duplicate_ack()           another duplicate ACK arrived during fast recovery
+ *   in_recovery()                still in fast recovery (after an on_ack, true means a partial ACK)
+ *   set_mss( mss )               the segment size changed (MSS option or a path MTU probe); the window
+ *                                keeps its size in bytes, unless it is still the initial window
+ */
+
+// No congestion control: the sender is limited by the receiver's window only
+class UnlimitedWindow
+{
+public:
+  uint64_t cwnd() const { return UINT64_MAX; }
+  uint64_t ssthresh() const { return UINT64_MAX; }
+  void on_ack( uint64_t /* acked */, uint64_t /* ackno */, uint64_t /* now_ms */ ) {}
+  void on_timeout( uint64_t /* in_flight */, uint64_t /* now_ms */ ) {}
+  void on_fast_retransmit( uint64_t /* in_flight */, uint64_t /* recover */, uint64_t /* now_ms */, bool /* sack */ )
+  {}
+  void on_duplicate_ack() {}
+  bool in_recovery() const { return false; }
+  void set_mss( uint64_t /* mss */ ) {}
+};
+
+// RFC 5681: slow start, congestion avoidance, and fast recovery that ends on the first new ACK
+class Reno
+{
+protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { UINT64_MAX };
+  uint64_t acked_in_avoidance_ { 0 }; // bytes acked since cwnd last grew in congestion avoidance
+  bool in_recovery_ { false };
+  bool sack_recovery_ { false }; // 这次快速恢复由 SACK 的 pipe 控制发送 (窗口不膨胀)
+  uint64_t recover_ { 0 };
+
+  void grow( uint64_t acked );
+  void reduce( uint64_t in_flight ); // ssthresh = max( in_flight / 2, 2 * MSS )
+
+  static uint64_t initial_window( uint64_t mss );
+
+public:
+  explicit Reno( uint64_t mss );
+
+  uint64_t cwnd() const { return cwnd_; }
+  uint64_t ssthresh() const { return ssthresh_; }
+  void on_ack( uint64_t acked, uint64_t ackno, uint64_t now_ms );
+  void on_timeout( uint64_t in_flight, uint64_t now_ms );
+  void on_fast_retransmit( uint64_t in_flight, uint64_t recover, uint64_t now_ms, bool sack );
+  void on_duplicate_ack();
+  bool in_recovery() const { return in_recovery_; }
+  void set_mss( uint64_t mss );
+};
+
+// RFC 6582: like Reno, but a partial ACK (below `recover`) keeps the sender in fast recovery,
+// deflating the window by the amount acked, so each further hole is retransmitted without a timeout
+class NewReno : public Reno
+{
+public:
+  using Reno::Reno;
+  void on_ack( uint64_t acked, uint64_t ackno, uint64_t now_ms );
+};
+
+// RFC 9438: after a loss the window follows a cubic function of the time since the reduction,
+// plateauing around the window where the loss happened (w_max), but never grows slower than Reno would
+class Cubic : public NewReno
+{
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+  double w_max_ { 0 };           // window before the last reduction, in segments
+  double w_est_ { 0 };           // Reno-friendly estimate, in segments
+  double k_ { 0 };               // seconds from the epoch start until the window reaches w_max_
+  uint64_t epoch_start_ms_ { 0 };
+  bool epoch_started_ { false };
+
+  void reduce_cubic( uint64_t now_ms );
+
+public:
+  using NewReno::NewReno;
+  void on_ack( uint64_t acked, uint64_t ackno, uint64_t now_ms );
+  void on_timeout( uint64_t in_flight, uint64_t now_ms );
+  void on_fast_retransmit( uint64_t in_flight, uint64_t recover, uint64_t now_ms, bool sack );
+};
+
+// The algorithm chosen by TCPConfig::congestion_control
+class CongestionController
+{
+  std::variant<UnlimitedWindow, Reno, NewReno, Cubic> algorithm_;
+
+public:
+  CongestionController( TCPConfig::CongestionControl algorithm, uint64_t mss );
+
+  bool enabled() const { return not std::holds_alternative<UnlimitedWindow>( algorithm_ ); }
+
+  uint64_t cwnd() const;
+  uint64_t ssthresh() const;
+  void on_ack( uint64_t acked, uint64_t ackno, uint64_t now_ms );
+  void on_timeout( uint64_t in_flight, uint64_t now_ms );
+  void on_fast_retransmit( uint64_t in_flight, uint64_t recover, uint64_t now_ms, bool sack );
+  void on_duplicate_ack();
+  bool in_recovery() const;
+  void set_mss( uint64_t mss );
+};
@@ -7,15 +7,19 @@ using namespace std;
 
 // ethernet_address: Ethernet (what ARP calls "hardware") address of the interface
 // ip_address: IP (what ARP calls "protocol") address of the interface
-NetworkInterface::NetworkInterface( const EthernetAddress& ethernet_address, const Address& ip_address )
+NetworkInterface::NetworkInterface( const EthernetAddress& ethernet_address,
+                                    const Address& ip_address,
+                                    size_t mtu )
   : ethernet_address_( ethernet_address )
   , ip_address_( ip_address )
+  , timers_()
   , ip_to_mac_()
   , arp_timer_()
   , waited_dagrams_()
   , out_frames_()
   , IP_MAP_TTL( 30000 )
   , ARP_TTL( 5000 )
+  , mtu_( mtu )
 {
   cerr << "DEBUG: Network interface has Ethernet address " << to_string( ethernet_address_ ) << " and IP address "
        << ip_address.ip() << "\n";
@@ -31,6 +35,8 @@ void NetworkInterface::send_datagram( const InternetDatagram& dgram, const Addre
 {
   // 如果destination Ethertnet address已知，直接发送
   // 如果destination Ethertnet address未知，发送ARP request，将dgram入队列，等待ARP reply
+  if ( dgram.header.len > mtu_ ) // 超过 MTU 的数据报无法发送 (也不分片)，发送方要靠 PMTU 探测找到合适的大小
+    return;
   uint32_t target_ip = next_hop.ipv4_numeric();
   if ( ip_to_mac_.count( target_ip ) ) { // 在ARP映射表内，直接发送，推入待发送队列out_frames_
     // 构建以太网帧
@@ -56,7 +62,10 @@ void NetworkInterface::send_datagram( const InternetDatagram& dgram, const Addre
                              serialize( arpmsg ) };
       // 发送ARP请求，目的MAC地址是BROADCAST
       out_frames_.push( eframe );
-      arp_timer_.emplace( next_hop.ipv4_numeric(), 0 );
+      arp_timer_.emplace( target_ip,
+                          timers_.schedule( ARP_TTL, [target_ip]( NetworkInterface& self ) {
+                            self.arp_timer_.erase( target_ip ); // 5秒内没有回复，允许重发
+                          } ) );
       waited_dagrams_.insert( { target_ip, { dgram } } );
     } else {
       waited_dagrams_[target_ip].push_back( dgram );
@@ -81,7 +90,14 @@ optional<InternetDatagram> NetworkInterface::recv_frame( const EthernetFrame& fr
     ARPMessage arpmsg;
     if ( parse( arpmsg, frame.payload ) ) { // 如果解析没有错误
       // 更新自己的ARP表
-      ip_to_mac_.insert( { arpmsg.sender_ip_address, { arpmsg.sender_ethernet_address, 0 } } );
+      const uint32_t sender_ip = arpmsg.sender_ip_address;
+      if ( !ip_to_mac_.count( sender_ip ) ) {
+        ip_to_mac_.emplace( sender_ip,
+                            pair { arpmsg.sender_ethernet_address,
+                                   timers_.schedule( IP_MAP_TTL, [sender_ip]( NetworkInterface& self ) {
+                                     self.ip_to_mac_.erase( sender_ip ); // 缓存30秒后过期
+                                   } ) } );
+      }
       if ( arpmsg.opcode == ARPMessage::OPCODE_REPLY ) {
         // 这个是应答，是自己发送ARP请求，别人回答，这时候可以把自己的waited_dagrams_内的相应的数据报发送出去
         vector<InternetDatagram> datas = waited_dagrams_[arpmsg.sender_ip_address];
@@ -114,24 +130,8 @@ optional<InternetDatagram> NetworkInterface::recv_frame( const EthernetFrame& fr
 // ms_since_last_tick: the number of milliseconds since the last call to this method
 void NetworkInterface::tick( const size_t ms_since_last_tick )
 {
-  // 保证ip_to_mac_里面的总是新的，所以在发送的时候就不需要单独考虑有没有过时
-  for ( auto it = ip_to_mac_.begin(); it != ip_to_mac_.end(); ) {
-    it->second.second += ms_since_last_tick;
-    if ( it->second.second >= IP_MAP_TTL ) {
-      it = ip_to_mac_.erase( it );
-    } else {
-      ++it;
-    }
-  }
-  // 保证arp_timer_里面的总是最近发送的，所以在发送arp请求的时候如果没有，则发送，如果有，则#64
-  for ( auto it = arp_timer_.begin(); it != arp_timer_.end(); ) {
-    it->second += ms_since_last_tick;
-    if ( it->second >= ARP_TTL ) {
-      it = arp_timer_.erase( it );
-    } else {
-      ++it;
-    }
-  }
+  // 到期的映射和ARP请求由各自的定时器删除，保证ip_to_mac_里面的总是新的
+  timers_.advance( ms_since_last_tick, *this );
 }
 
 optional<EthernetFrame> NetworkInterface::maybe_send()
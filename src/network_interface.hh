@@ -3,6 +3,7 @@
 #include "address.hh"
 #include "ethernet_frame.hh"
 #include "ipv4_datagram.hh"
+#include "timer_wheel.hh"
 
 #include <iostream>
 #include <list>
@@ -40,18 +41,28 @@ private:
 
   // IP (known as Internet-layer or network-layer) address of the interface
   Address ip_address_; // 32位IP地址
-  std::unordered_map<uint32_t, std::pair<EthernetAddress, size_t>>
-    ip_to_mac_; // IP地址与MAC地址之间的映射，第二个参数表示已经缓存的时间
-  std::unordered_map<uint32_t, size_t> arp_timer_; // 存放发送的ARP帧的ip和时间,避免重发
+
+  // Expiry of ARP mappings and requests; tick() only touches the entries that expire
+  using Timers = TimerWheel<NetworkInterface&>;
+  Timers timers_;
+  std::unordered_map<uint32_t, std::pair<EthernetAddress, Timers::Id>>
+    ip_to_mac_; // IP地址与MAC地址之间的映射，第二个参数是到期删除它的定时器
+  std::unordered_map<uint32_t, Timers::Id> arp_timer_; // 存放发送过ARP请求的ip和它的定时器,避免重发
   std::unordered_map<uint32_t, std::vector<InternetDatagram>> waited_dagrams_; // iptoMac映射未知时，等待的数据报
   std::queue<EthernetFrame> out_frames_;                                       // 等待发送的帧
   const size_t IP_MAP_TTL;
   const size_t ARP_TTL;
+  size_t mtu_; // 能发送的最大数据报 (字节)，更大的直接丢弃 (不分片)
 
 public:
+  static constexpr size_t DEFAULT_MTU = 1500; // Ethernet
+
   // Construct a network interface with given Ethernet (network-access-layer) and IP (internet-layer)
-  // addresses
-  NetworkInterface( const EthernetAddress& ethernet_address, const Address& ip_address );
+  // addresses, sending datagrams of at most `mtu` bytes
+  NetworkInterface( const EthernetAddress& ethernet_address, const Address& ip_address, size_t mtu = DEFAULT_MTU );
+
+  // Largest datagram the interface sends; larger ones are dropped, as if they had the Don't Fragment bit
+  size_t mtu() const { return mtu_; }
 
   // Access queue of Ethernet frames awaiting transmission
   std::optional<EthernetFrame> maybe_send();
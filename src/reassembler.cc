@@ -1,8 +1,111 @@
 #include "reassembler.hh"
+
+#include <algorithm>
+#include <bit>
+
 using namespace std;
 
+namespace {
+
+// Calls f( word_index, mask ) for the words covering bits [begin, end) of a bitmap of `size` bits,
+// in index order (wrapping at most once), until f returns true.
+template<typename F>
+void for_each_mask( const uint64_t size, const uint64_t begin, const uint64_t end, F&& f )
+{
+  const auto linear = [&]( uint64_t lo, const uint64_t hi ) {
+    while ( lo < hi ) {
+      const uint64_t bit = lo % 64;
+      const uint64_t n = min( hi - lo, 64 - bit );
+      const uint64_t mask = ( n == 64 ? ~uint64_t {} : ( uint64_t { 1 } << n ) - 1 ) << bit;
+      if ( f( lo / 64, mask ) ) {
+        return true;
+      }
+      lo += n;
+    }
+    return false;
+  };
+  const uint64_t first = begin % size;
+  const uint64_t first_part = min( end - begin, size - first );
+  if ( not linear( first, first + first_part ) ) {
+    linear( 0, end - begin - first_part );
+  }
+}
+
+} // namespace
+
+void PresenceBitmap::grow( const uint64_t bits, const uint64_t base )
+{
+  if ( bits <= size() ) {
+    return;
+  }
+  PresenceBitmap grown;
+  grown.words_.resize( max( ( bits + 63 ) / 64, 2 * words_.size() ) );
+  for ( uint64_t w = 0; w < words_.size(); ++w ) {
+    for ( uint64_t word = words_[w]; word != 0; word &= word - 1 ) {
+      const uint64_t position = w * 64 + countr_zero( word );
+      const uint64_t index = base + ( position + size() - base % size() ) % size();
+      grown.set( index, index + 1 );
+    }
+  }
+  words_ = move( grown.words_ );
+}
+
+uint64_t PresenceBitmap::set( const uint64_t begin, const uint64_t end )
+{
+  uint64_t newly_set = 0;
+  for_each_mask( size(), begin, end, [&]( const uint64_t w, const uint64_t mask ) {
+    newly_set += popcount( ~words_[w] & mask );
+    words_[w] |= mask;
+    return false;
+  } );
+  return newly_set;
+}
+
+void PresenceBitmap::clear( const uint64_t begin, const uint64_t end )
+{
+  for_each_mask( size(), begin, end, [&]( const uint64_t w, const uint64_t mask ) {
+    words_[w] &= ~mask;
+    return false;
+  } );
+}
+
+uint64_t PresenceBitmap::first_clear( const uint64_t begin, const uint64_t end ) const
+{
+  uint64_t found = end;
+  for_each_mask( size(), begin, end, [&]( const uint64_t w, const uint64_t mask ) {
+    const uint64_t unset = ~words_[w] & mask;
+    if ( unset == 0 ) {
+      return false;
+    }
+    const uint64_t position = w * 64 + countr_zero( unset );
+    found = begin + ( position + size() - begin % size() ) % size();
+    return true;
+  } );
+  return found;
+}
+
+uint64_t PresenceBitmap::first_set( const uint64_t begin, const uint64_t end ) const
+{
+  uint64_t found = end;
+  for_each_mask( size(), begin, end, [&]( const uint64_t w, const uint64_t mask ) {
+    const uint64_t set = words_[w] & mask;
+    if ( set == 0 ) {
+      return false;
+    }
+    const uint64_t position = w * 64 + countr_zero( set );
+    found = begin + ( position + size() - begin % size() ) % size();
+    return true;
+  } );
+  return found;
+}
+
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring, Writer& output )
 {
+  if ( mode_ == Mode::InPlace && output.storage() == ByteStream::Storage::Ring ) {
+    insert_in_place( first_index, data, is_last_substring, output );
+    return;
+  }
+
   if ( data.empty() ) {
     if ( is_last_substring ) {
       output.close();
@@ -59,50 +162,127 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
 
 uint64_t Reassembler::bytes_pending() const
 {
-  return buffer_size;
+  return buffer_size + present_count_;
 }
 
-void Reassembler::insert_into_buffer( const uint64_t first_index, std::string&& data, const bool is_last_substring )
+vector<pair<uint64_t, uint64_t>> Reassembler::pending_ranges( const size_t max_ranges ) const
 {
-  auto begin_index = first_index;
-  const auto end_index = first_index + data.size();
+  vector<pair<uint64_t, uint64_t>> ranges;
 
-  for ( auto it = buffer.begin(); it != buffer.end() && begin_index < end_index; ) {
-    if ( begin_index >= it->first ) {
-      begin_index = max(
-        begin_index, it->first + it->second.size() ); // it->first + it->second.size() 是当前缓冲区一个数据片的结尾
-      ++it; // 跳到下一个数据片，因为从begin_index开始到it->first + it->second.size()的数据已经全部在缓冲区了
-      continue;
+  // InPlace: runs of set bits (all of them lie within one bitmap's length of first_unassembled_index)
+  if ( present_count_ > 0 ) {
+    const auto window_end = first_unassembled_index + present_.size();
+    auto begin = present_.first_set( first_unassembled_index, window_end );
+    while ( begin < window_end && ranges.size() < max_ranges ) {
+      const auto end = present_.first_clear( begin, window_end );
+      ranges.emplace_back( begin, end );
+      begin = present_.first_set( end, window_end );
     }
+  }
 
-    if ( begin_index == first_index && end_index <= it->first ) { // data 在 it 之前，直接插入就结束
-      buffer_size += data.size();
-      buffer.emplace(
-        it, first_index, std::move( data ) ); // 在 it 之前插入一个数据片, data用完之后可以废弃，所以用move
-      return;
+  // Buffered: the fragments, joining any that touch
+  for ( const auto& [index, fragment] : buffer ) {
+    const auto end = index + fragment.size();
+    if ( not ranges.empty() && ranges.back().second == index ) {
+      ranges.back().second = end;
+    } else if ( ranges.size() < max_ranges ) {
+      ranges.emplace_back( index, end );
+    } else {
+      break;
     }
+  }
+
+  return ranges;
+}
+
+void Reassembler::insert_in_place( const uint64_t first_index,
+                                   const string_view data,
+                                   const bool is_last_substring,
+                                   Writer& output )
+{
+  const auto end_index = first_index + data.size();
+  const auto first_unacceptable = first_unassembled_index + output.available_capacity();
 
-    // 下面的情况data可能横跨多个数据片
-    const auto right_index = min( it->first, end_index );
-    const auto len = right_index - begin_index;
-    buffer.emplace(
-      it,
-      begin_index,
-      data.substr( begin_index - first_index,
-                   len ) ); // 插入一个数据片，（直接于 pos 前插入元素到容器中）操作之后，it 仍然指向原来的元素
-    buffer_size += len;
-    begin_index = right_index;
+  // a last substring that doesn't fit entirely doesn't mark the end yet
+  if ( is_last_substring && end_index <= first_unacceptable ) {
+    last_index_ = end_index;
   }
 
-  // 缓冲区访问完了，但是data还有剩余
-  if ( begin_index < end_index ) {
-    buffer_size += end_index - begin_index;
-    buffer.emplace_back( begin_index, data.substr( begin_index - first_index ) ); // 在缓冲区末尾插入一个数据片
+  // the part of data within [first_unassembled_index, first_unacceptable)
+  const auto begin = max( first_index, first_unassembled_index );
+  const auto end = min( end_index, first_unacceptable );
+  if ( begin < end ) {
+    const auto fragment = data.substr( begin - first_index, end - begin );
+    if ( begin == first_unassembled_index && present_count_ == 0 ) { // 按序到达且没有等待的数据：直接写入
+      output.write_reserved( 0, fragment );
+      output.commit( fragment.size() );
+      first_unassembled_index = end;
+    } else { // 写到最终位置，记在位图里，等前面的空洞补上
+      present_.grow( output.available_capacity(), first_unassembled_index );
+      output.write_reserved( begin - first_unassembled_index, fragment );
+      present_count_ += present_.set( begin, end );
+
+      const auto hole = present_.first_clear( first_unassembled_index, first_unacceptable );
+      if ( hole > first_unassembled_index ) {
+        present_.clear( first_unassembled_index, hole );
+        present_count_ -= hole - first_unassembled_index;
+        output.commit( hole - first_unassembled_index );
+        first_unassembled_index = hole;
+      }
+    }
   }
 
+  if ( last_index_.has_value() && first_unassembled_index >= *last_index_ ) {
+    output.close();
+  }
+}
+
+void Reassembler::insert_into_buffer( const uint64_t first_index, std::string&& data, const bool is_last_substring )
+{
   if ( is_last_substring ) {
     has_last = true;
   }
+
+  const auto end_index = first_index + data.size();
+
+  // the first fragment that starts after first_index; the one before it may overlap or touch data
+  auto it = buffer.upper_bound( first_index );
+  if ( it != buffer.begin() ) {
+    auto prev = std::prev( it );
+    const auto prev_end = prev->first + prev->second.size();
+    if ( prev_end >= end_index ) { // data 已经全部在缓冲区了
+      return;
+    }
+    if ( prev_end >= first_index ) { // 与前一个数据片重叠或相邻：把不重复的部分接到它后面
+      const auto tail = std::string_view { data }.substr( prev_end - first_index );
+      buffer_size += tail.size();
+      prev->second.append( tail );
+      trim_overlapping_after( prev, end_index );
+      return;
+    }
+  }
+
+  buffer_size += data.size();
+  it = buffer.emplace_hint( it, first_index, std::move( data ) );
+  trim_overlapping_after( it, end_index );
+}
+
+void Reassembler::trim_overlapping_after( std::map<uint64_t, std::string>::iterator fragment, uint64_t end_index )
+{
+  // fragments wholly covered by the one just grown are dropped; one that starts inside it and
+  // extends further is kept, and the grown fragment is cut short (which never copies) to end where it begins
+  for ( auto it = std::next( fragment ); it != buffer.end() && it->first < end_index; ) {
+    const auto it_end = it->first + it->second.size();
+    if ( it_end <= end_index ) {
+      buffer_size -= it->second.size();
+      it = buffer.erase( it );
+      continue;
+    }
+    const auto cut = end_index - it->first;
+    fragment->second.resize( fragment->second.size() - cut );
+    buffer_size -= cut;
+    break;
+  }
 }
 
 void Reassembler::pop_from_buffer( Writer& output )
@@ -130,4 +310,4 @@ void Reassembler::pop_from_buffer( Writer& output )
   if ( buffer.empty() && has_last ) {
     output.close();
   }
-}
\ No newline at end of file
+}
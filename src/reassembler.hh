@@ -1,23 +1,73 @@
 #pragma once
 #include "byte_stream.hh"
 
-#include <list>
 #include <map>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
+
+// One presence bit per stream index, stored in 64-bit words and indexed modulo size()
+// (so it can cover a sliding window without shifting). All ranges must lie within one window.
+class PresenceBitmap
+{
+  std::vector<uint64_t> words_ {};
+
+public:
+  uint64_t size() const { return words_.size() * 64; }
+
+  // Grow to cover at least `bits` indices, keeping the bits of [base, base + old size)
+  void grow( uint64_t bits, uint64_t base );
+
+  uint64_t set( uint64_t begin, uint64_t end ); // Set [begin, end), returns how many bits were newly set
+  void clear( uint64_t begin, uint64_t end );   // Clear [begin, end)
+  uint64_t first_clear( uint64_t begin, uint64_t end ) const; // First clear index in [begin, end), else `end`
+  uint64_t first_set( uint64_t begin, uint64_t end ) const;   // First set index in [begin, end), else `end`
+};
+
 class Reassembler
 {
+public:
+  /*
+   * Where out-of-order bytes wait:
+   *   InPlace:  copied straight into the output's free space (Writer::write_reserved), at their final
+   *             position, with a PresenceBitmap; they are committed once the hole before them fills.
+   *             Needs a Ring-storage ByteStream, and falls back to Buffered for any other.
+   *   Buffered: kept in the Reassembler's own strings and pushed when the hole fills.
+   */
+  enum class Mode : uint8_t
+  {
+    InPlace,
+    Buffered
+  };
+
 private:
+  Mode mode_ { Mode::InPlace };
   uint64_t first_unassembled_index { 0 };
 
-  std::list<std::pair<uint64_t, std::string>> buffer {};
+  // InPlace state
+  PresenceBitmap present_ {};
+  uint64_t present_count_ { 0 }; // bits set in present_ (written but not committed)
+  std::optional<uint64_t> last_index_ {}; // end of the last substring, once known
+
+  void insert_in_place( uint64_t first_index, std::string_view data, bool is_last_substring, Writer& output );
+
+  // Pending bytes, keyed by stream index. Fragments never overlap; new bytes that extend a
+  // fragment are appended to it, so in-order arrivals coalesce into one entry.
+  std::map<uint64_t, std::string> buffer {};
   uint64_t buffer_size { 0 };
   bool has_last { false };
   void insert_into_buffer( uint64_t first_index, std::string&& data, bool is_last_substring );
+  // drop or trim the fragments after `fragment` that overlap it (it now ends at end_index)
+  void trim_overlapping_after( std::map<uint64_t, std::string>::iterator fragment, uint64_t end_index );
 
   // pop invalid bytes and insert valid bytes into writer
   void pop_from_buffer( Writer& output );
 
 public:
+  Reassembler() = default;
+  explicit Reassembler( Mode mode ) : mode_( mode ) {}
+
   /*
    * Insert a new substring to be reassembled into a ByteStream.
    *   `first_index`: the index of the first byte of the substring
@@ -43,4 +93,7 @@ public:
 
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
+
+  // The stream-index ranges [begin, end) of those bytes, lowest first (at most `max_ranges` of them)
+  std::vector<std::pair<uint64_t, uint64_t>> pending_ranges( size_t max_ranges ) const;
 };
@@ -30,9 +30,7 @@ void Router::route()
     if ( received_dgram.has_value() ) {
       auto& dgram = received_dgram.value();
       if ( dgram.header.ttl > 1 ) {
-        dgram.header.ttl--;
-
-        dgram.header.compute_checksum();
+        dgram.header.decrement_ttl(); // 增量更新校验和 (RFC 1624)
         auto dst_ip = dgram.header.dst;
         auto it = longest_prefix_match_( dst_ip );
         // it 是路由表中最长前缀匹配的项
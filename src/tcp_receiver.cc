@@ -8,9 +8,19 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
   if ( message.SYN ) { // 表示这是一个SYN包，说明在建立连接
     isn = message.seqno;
     rcv_syn = true;
+    ts_recent = message.timestamp;
   }
   if ( !rcv_syn ) // 没有收到SYN包但是，SYN之后的包到达，说明还没有建立连接，不接收数据，直接返回
     return;
+  if ( message.timestamp.has_value() && ts_recent.has_value() && !message.SYN ) {
+    // PAWS (RFC 7323 5.3): 时间戳比 TS.Recent 还旧的是之前的重复数据段，即使序列号已经回绕到了窗口内
+    if ( static_cast<int32_t>( message.timestamp.value() - ts_recent.value() ) < 0 )
+      return;
+    // 只有不超过 ackno 的数据段 (按序到达的) 才更新要回显的时间戳 (RFC 7323 4.3)
+    if ( message.seqno.unwrap( isn, inbound_stream.bytes_pushed() )
+         <= inbound_stream.bytes_pushed() + 1 + inbound_stream.is_closed() )
+      ts_recent = message.timestamp;
+  }
   uint64_t abs_seqno = message.seqno.unwrap(
     isn, inbound_stream.bytes_pushed() ); // 转换成绝对序列号, 离已经传输的字节数最近的绝对序列号
   if (
@@ -27,9 +37,26 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
 TCPReceiverMessage TCPReceiver::send( const Writer& inbound_stream ) const
 {
   // Your code here.
-  uint16_t window_size = static_cast<uint16_t>( std::min(
-    inbound_stream.available_capacity(), uint64_t( UINT16_MAX ) ) ); // 因为window_size是16位的，所以要转换成16位
+  uint16_t window_size = static_cast<uint16_t>(
+    std::min( inbound_stream.available_capacity() >> window_shift,
+              uint64_t( UINT16_MAX ) ) ); // 因为window_size是16位的，所以要转换成16位 (缩放之后)
   std::optional<Wrap32> ackno = Wrap32::wrap( inbound_stream.bytes_pushed() + rcv_syn + inbound_stream.is_closed(),
                                               isn ); // ackno是相对序列号，表明下一个期望接收的序列号，之前都收到了
-  return TCPReceiverMessage( { rcv_syn ? ackno : std::nullopt, window_size } );
+  TCPReceiverMessage msg { rcv_syn ? ackno : std::nullopt, window_size };
+  if ( rcv_syn ) {
+    msg.timestamp_echo = ts_recent; // TSecr
+  }
+  return msg;
+}
+
+TCPReceiverMessage TCPReceiver::send( const Writer& inbound_stream, const Reassembler& reassembler ) const
+{
+  TCPReceiverMessage msg = send( inbound_stream );
+  if ( rcv_syn ) {
+    for ( const auto& [begin, end] : reassembler.pending_ranges( TCPReceiverMessage::MAX_SACK_BLOCKS ) ) {
+      // 流下标 + 1 (SYN) 才是绝对序列号
+      msg.sack.push_back( { Wrap32::wrap( begin + 1, isn ), Wrap32::wrap( end + 1, isn ) } );
+    }
+  }
+  return msg;
 }
@@ -7,8 +7,12 @@
 class TCPReceiver
 {
 protected:
-  Wrap32 isn { 0 };       // 初始序列号
-  bool rcv_syn { false }; // 是否接收到syn
+  Wrap32 isn { 0 };           // 初始序列号
+  bool rcv_syn { false };     // 是否接收到syn
+  uint8_t window_shift { 0 }; // 通告窗口右移的位数 (RFC 7323 窗口缩放)
+
+  // RFC 7323 timestamps: the TSval to echo (TS.Recent), also used to reject old duplicates (PAWS)
+  std::optional<uint32_t> ts_recent {};
 
 public:
   /*
@@ -19,4 +23,10 @@ public:
 
   /* The TCPReceiver sends TCPReceiverMessages back to the TCPSender. */
   TCPReceiverMessage send( const Writer& inbound_stream ) const;
+
+  /* The same, with SACK blocks for the bytes the Reassembler is holding */
+  TCPReceiverMessage send( const Writer& inbound_stream, const Reassembler& reassembler ) const;
+
+  /* Advertise the window in units of 2^shift bytes (negotiated with the window scale option) */
+  void set_window_scale( uint8_t shift ) { window_shift = shift; }
 };
@@ -1,20 +1,41 @@
 #include "tcp_sender.hh"
+#include "checksum.hh"
 #include "tcp_config.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 using namespace std;
 
 /* TCPSender constructor (uses a random ISN if none given) */
 TCPSender::TCPSender( uint64_t initial_RTO_ms, optional<Wrap32> fixed_isn )
-  : isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) ), initial_RTO_ms_( initial_RTO_ms )
+  : isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) )
+  , initial_RTO_ms_( initial_RTO_ms )
+  , congestion_( TCPConfig::CongestionControl::None, TCPConfig::MAX_PAYLOAD_SIZE )
+{}
+
+TCPSender::TCPSender( const TCPConfig& config )
+  : isn_( config.fixed_isn.value_or( Wrap32 { random_device()() } ) )
+  , initial_RTO_ms_( config.rt_timeout )
+  , mss_limit_( config.mss )
+  , mss_( config.mtu_probing ? min( TCPConfig::MAX_PAYLOAD_SIZE, config.mss ) : config.mss )
+  , mtu_probing_( config.mtu_probing )
+  , probe_high_( config.mss + 1 )
+  , congestion_( config.congestion_control, mss_ )
+  , adaptive_rto_( config.adaptive_rto )
+  , rto_min_ms_( config.adaptive_rto ? config.rto_min : 0 )
+  , rto_max_ms_( config.adaptive_rto ? config.rto_max : UINT64_MAX )
+  , timestamps_( config.timestamps )
+  , pacing_( config.pacing )
+  , configured_pacing_rate_( config.pacing_rate )
 {}
 
 uint64_t TCPSender::sequence_numbers_in_flight() const
 {
   // Your code here.
   // 有多少序列号在飞行（发送中）
-  return outstanding_cnt;
+  return in_flight();
 }
 
 uint64_t TCPSender::consecutive_retransmissions() const
@@ -24,16 +45,156 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return retransmit_cnt_;
 }
 
+uint64_t TCPSender::congestion_window() const
+{
+  return congestion_.cwnd();
+}
+
+uint64_t TCPSender::slow_start_threshold() const
+{
+  return congestion_.ssthresh();
+}
+
+uint64_t TCPSender::smoothed_rtt() const
+{
+  return llround( srtt_ms_ );
+}
+
+uint64_t TCPSender::rtt_variation() const
+{
+  return llround( rttvar_ms_ );
+}
+
+uint64_t TCPSender::retransmission_timeout() const
+{
+  return timer.RTO();
+}
+
+uint64_t TCPSender::pacing_rate() const
+{
+  if ( !pacing_ ) {
+    return 0;
+  }
+  if ( configured_pacing_rate_ > 0 ) {
+    return configured_pacing_rate_;
+  }
+  if ( !congestion_.enabled() || !rtt_measured_ ) { // 还不知道一个窗口要多长时间
+    return 0;
+  }
+  // 一个 RTT 发完一个拥塞窗口，再留一些余量，慢启动时让窗口还能翻倍 (与 Linux 的比例相同)
+  const double gain = congestion_.cwnd() < congestion_.ssthresh() ? 2.0 : 1.2;
+  return llround( gain * static_cast<double>( congestion_.cwnd() ) * 1000 / max( srtt_ms_, 1.0 ) );
+}
+
+optional<uint64_t> TCPSender::next_deadline() const
+{
+  optional<uint64_t> deadline;
+  if ( timer.is_running() ) {
+    deadline = timer.remaining();
+  }
+  if ( const auto rate = pacing_rate(); rate > 0 && !queued_segments.empty() ) {
+    // 令牌攒够下一个数据段要多久
+    const auto cost = static_cast<double>( pacing_cost( queued_segments.front() ) );
+    const double missing = max( cost - pacing_credit_, 0.0 );
+    const auto wait = static_cast<uint64_t>( ceil( missing * 1000 / static_cast<double>( rate ) ) );
+    deadline = min( deadline.value_or( UINT64_MAX ), max<uint64_t>( wait, 1 ) );
+  }
+  return deadline;
+}
+
+uint64_t TCPSender::max_segment_size() const
+{
+  return mss_limit_;
+}
+
+uint64_t TCPSender::segment_size() const
+{
+  return mss_;
+}
+
+void TCPSender::set_mss( uint64_t mss )
+{
+  mss_limit_ = mss;
+  mss_ = mtu_probing_ ? base_mss() : mss;
+  probe_high_ = mss + 1;
+  probe_.reset();
+  congestion_.set_mss( mss_ );
+}
+
+uint64_t TCPSender::next_probe_size() const
+{
+  // 一次只探测一个，而且不在丢包恢复的时候探测
+  if ( !mtu_probing_ || probe_.has_value() || retransmit_cnt_ > 0 || congestion_.in_recovery() )
+    return 0;
+  if ( probe_high_ <= mss_ + PROBE_STEP ) // 搜索已经结束
+    return 0;
+  // 先直接试最大的 (路径通常能通过)，失败之后再二分
+  return probe_high_ > mss_limit_ ? mss_limit_ : ( mss_ + probe_high_ ) / 2;
+}
+
+uint64_t TCPSender::pacing_cost( const Segment& segment ) const
+{
+  return segment.payload_size() > mss_ && !is_probe( segment ) ? segment.SYN + mss_ : segment.length;
+}
+
+void TCPSender::split_front()
+{
+  Segment& front = queued_segments.front();
+  if ( front.payload_size() <= mss_ || is_probe( front ) )
+    return;
+  // 比现在的数据段大小大的重传 (失败的探测，或者退回基础大小之前发出的)：先发前 mss_ 个字节
+  const Segment rest { front.seqno + front.SYN + mss_, front.payload_size() - mss_ + front.FIN, false, front.FIN };
+  front.length = front.SYN + mss_;
+  front.FIN = false;
+  queued_segments.insert( queued_segments.begin() + 1, rest );
+}
+
 optional<TCPSenderMessage> TCPSender::maybe_send()
 {
   // Your code here.
   // 如果需要发送TCPSenderMessage，则发送（或者为空）
+  while ( !queued_segments.empty() && queued_segments.front().end() <= acked_seqno )
+    queued_segments.pop_front(); // 排队的重传在发出之前已经被确认了 (它的字节也已经释放)
   if ( queued_segments.empty() )
-    return {};               // 如果没有需要发送的TCPSenderMessage，则返回空
+    return {}; // 如果没有需要发送的TCPSenderMessage，则返回空
+  split_front();
+  if ( pacing_rate() > 0 ) { // 按节奏发送：令牌不够就等下一次 tick
+    const auto cost = static_cast<double>( pacing_cost( queued_segments.front() ) );
+    if ( pacing_credit_ < cost )
+      return {};
+    pacing_credit_ -= cost;
+  }
   if ( !timer.is_running() ) // 如果计时器没有运行
     timer.start();           // 启动计时器
-  TCPSenderMessage msg = queued_segments.front();
-  queued_segments.pop();
+  const Segment segment = queued_segments.front();
+  queued_segments.pop_front();
+
+  const uint64_t end = segment.end();
+  if ( end > released_seqno_ ) { // 第一次发送 (不是重传)
+    released_seqno_ = end;
+    if ( !rtt_timing_ ) { // 为这个数据段计时，直到它被确认
+      rtt_timing_ = true;
+      rtt_timed_end_ = end;
+      rtt_timed_at_ms_ = now_ms_;
+    }
+  }
+  return make_message( segment );
+}
+
+TCPSenderMessage TCPSender::make_message( const Segment& segment ) const
+{
+  TCPSenderMessage msg { Wrap32::wrap( segment.seqno, isn_ ), segment.SYN, {}, segment.FIN };
+  if ( timestamps_ ) {
+    msg.timestamp = static_cast<uint32_t>( now_ms_ ); // TSval: 发送 (或重传) 的时间
+  }
+  if ( segment.payload_size() > 0 ) {
+    // 负载在流中的位置 (SYN 占用了序列号 0)，相对于最早保留的字节
+    const uint64_t first_index = segment.seqno + segment.SYN - 1;
+    const uint64_t retained_from = outbound_->bytes_popped() - outbound_->bytes_retained();
+    InternetChecksum payload_sum;
+    msg.payload = outbound_->peek_retained( first_index - retained_from, segment.payload_size(), &payload_sum );
+    msg.payload_sum = payload_sum.sum();
+  }
   return msg;
 }
 
@@ -41,37 +202,55 @@ void TCPSender::push( Reader& outbound_stream )
 {
   // Your code here.
   // 从出站流中推送字节，构建发送队列
-  uint64_t currwindow_size = max( window_size, (uint64_t)1 );
-  while ( outstanding_cnt < currwindow_size ) {
-    TCPSenderMessage msg;
-    msg.seqno = Wrap32::wrap( next_seqno, isn_ );
+  // 发送窗口：接收方窗口（为 0 时按 1 探测）与拥塞窗口中较小的一个
+  const uint64_t receiver_window = max( window_size, (uint64_t)1 );
+  // 还能发送多少序列号：接收窗口按最右边界算，拥塞窗口只算还在网络中的（被 SACK 的不算）
+  const auto room = [&] {
+    const uint64_t pipe = outstanding_cnt - sacked_cnt_;
+    const uint64_t cwnd = congestion_.cwnd();
+    return min( receiver_window > outstanding_cnt ? receiver_window - outstanding_cnt : 0,
+                cwnd > pipe ? cwnd - pipe : 0 );
+  };
+  outbound_ = &outbound_stream;
+  outbound_stream.retain( true ); // 发出的字节保留到被确认，重传时从流中重新取出
+
+  while ( room() > 0 ) {
+    Segment segment { next_seqno };
 
     if ( !syn_ ) { // 如果没有发送SYN
-      msg.SYN = syn_ = true;
+      segment.SYN = syn_ = true;
       outstanding_cnt += 1;
     }
 
-    uint64_t payload_size = min( TCPConfig::MAX_PAYLOAD_SIZE, (size_t)( currwindow_size - outstanding_cnt ) );
+    // 探测数据段：有足够的数据和窗口时，发一个比 mss_ 大的数据段
+    const uint64_t probe_size = next_probe_size();
+    const bool probe = probe_size > 0 && !segment.SYN && outbound_stream.bytes_buffered() >= probe_size
+                       && room() >= probe_size;
 
-    read( outbound_stream, payload_size, msg.payload ); // 从outbounm_stream读取payload_size字节 到msg.payload
+    // 从outbound_stream取出payload_size字节 (只是移到保留区，不复制)
+    const uint64_t payload_size = min( { probe ? probe_size : mss_, room(), outbound_stream.bytes_buffered() } );
+    outbound_stream.pop( payload_size );
 
-    outstanding_cnt += msg.payload.length();
+    outstanding_cnt += payload_size;
 
     // 判断是否需要发送FIN
-    if ( !fin_ && outbound_stream.is_finished() && outstanding_cnt < currwindow_size ) {
+    if ( !fin_ && outbound_stream.is_finished() && room() > 0 ) {
       fin_ = true;
-      msg.FIN = true;
+      segment.FIN = true;
       outstanding_cnt += 1;
     }
 
-    if ( msg.sequence_length() == 0 )
+    segment.length = segment.SYN + payload_size + segment.FIN;
+    if ( segment.length == 0 )
       break;
 
-    queued_segments.push( msg );
-    outstanding_segments.push( msg );
-    next_seqno += msg.sequence_length();
+    queued_segments.push_back( segment );
+    outstanding_segments.push_back( segment );
+    if ( probe )
+      probe_ = segment;
+    next_seqno += segment.length;
 
-    if ( msg.FIN || outbound_stream.bytes_buffered() == 0 ) // 如果发送了FIN或者outbound_stream没有数据了
+    if ( segment.FIN || outbound_stream.bytes_buffered() == 0 ) // 如果发送了FIN或者outbound_stream没有数据了
       break;
   }
 }
@@ -81,15 +260,20 @@ TCPSenderMessage TCPSender::send_empty_message() const
   // Your code here.
   // 生成一个空的TCPSenderMessage
   Wrap32 seqno = Wrap32::wrap( next_seqno, isn_ );
-  return TCPSenderMessage { seqno, false, {}, false };
+  TCPSenderMessage msg { seqno, false, {}, false };
+  if ( timestamps_ ) {
+    msg.timestamp = static_cast<uint32_t>( now_ms_ );
+  }
+  return msg;
 }
 
-void TCPSender::receive( const TCPReceiverMessage& msg )
+void TCPSender::receive( const TCPReceiverMessage& msg, bool pure_ack )
 {
   // Your code here.
   // 接收并处理来自对等方接收器的TCPReceiverMessage
   // 接受到的TCPReceiverMessage的确认号，处理已经发送的TCPSenderMessage
-  window_size = msg.window_size; // 更新窗口大小
+  const uint64_t previous_window = window_size;
+  window_size = static_cast<uint64_t>( msg.window_size ) << window_shift_; // 更新窗口大小
 
   if ( msg.ackno.has_value() ) { // 如果有确认号
     auto ackno = msg.ackno.value().unwrap(
@@ -98,29 +282,203 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     if ( ackno > next_seqno ) // 如果确认号大于下一个要发送的序列号，说明有错误
       return;
 
+    if ( ackno < acked_seqno ) // 过时的 ACK（乱序到达），不能让已确认的序列号倒退
+      return;
+
+    // 重复 ACK：不带数据的 ACK，没有确认新数据，窗口也没变，而还有数据在飞行
+    const bool duplicate
+      = pure_ack && ackno == acked_seqno && in_flight() > 0 && window_size == previous_window;
+    const bool new_data_acked = ackno > acked_seqno;
+
+    if ( msg.timestamp_echo.has_value() ) { // 每个确认了新数据的 ACK 都是一个 RTT 样本 (RFC 7323 4.1)
+      rtt_timing_ = false;
+      if ( new_data_acked ) {
+        sample_rtt( static_cast<uint32_t>( now_ms_ ) - msg.timestamp_echo.value() ); // 32 位时钟回绕也没关系
+      }
+    } else if ( rtt_timing_ && ackno >= rtt_timed_end_ ) { // 被计时的数据段已经被确认
+      rtt_timing_ = false;
+      sample_rtt( now_ms_ - rtt_timed_at_ms_ );
+    }
+
+    if ( ackno > acked_seqno ) { // 新确认的数据让拥塞窗口增长 (SYN 不算)
+      const uint64_t newly_acked = ackno - acked_seqno - ( acked_seqno == 0 ? 1 : 0 );
+      if ( newly_acked > 0 ) {
+        congestion_.on_ack( newly_acked, ackno, now_ms_ );
+      }
+    }
+
     acked_seqno = ackno; // 更新已确认的序列号
 
+    if ( probe_.has_value() && acked_seqno >= probe_->end() ) { // 探测成功：路径能通过这么大的数据段
+      mss_ = probe_->payload_size();
+      congestion_.set_mss( mss_ );
+      probe_.reset();
+    }
+
     while ( !outstanding_segments.empty() ) {
-      auto front_msg = outstanding_segments.front();
-      if ( front_msg.sequence_length() + front_msg.seqno.unwrap( isn_, next_seqno ) <= acked_seqno ) {
-        // 说明当前的TCPSenderMessage已经被确认，可以从outstanding_segments中移除
+      const auto front = outstanding_segments.front();
+      if ( front.end() <= acked_seqno ) {
+        // 说明当前的数据段已经被确认，可以从outstanding_segments中移除
         // acked_seqno 可以覆盖数据段的所有字节
-        outstanding_segments.pop();
-        outstanding_cnt -= front_msg.sequence_length(); // 更新在飞行中的数量
+        outstanding_segments.pop_front();
+        outstanding_cnt -= front.length;             // 更新在飞行中的数量
+        if ( outbound_ != nullptr ) { // 数据段都来自 push()，它设置了 outbound_
+          outbound_->release( front.payload_size() ); // 不再需要保留它的字节
+        }
 
         timer.resetRTO();
-        if ( !outstanding_segments.empty() ) {
+        if ( in_flight() > 0 ) {
           timer.start();
         }
         retransmit_cnt_ = 0;
       } else {
-        // 说明当前的TCPSenderMessage还没有被确认，不能从outstanding_segments中移除
+        // 说明当前的数据段还没有被确认，不能从outstanding_segments中移除
         break;
       }
     }
 
-    if ( outstanding_segments.empty() )
+    if ( in_flight() == 0 ) // 剩下的 (如果有) 还在等节奏控制放行
       timer.stop();
+
+    update_scoreboard( msg );
+    retransmit_lost();
+
+    if ( duplicate && congestion_.enabled() ) { // 快速重传/快速恢复是拥塞控制的一部分 (RFC 5681)
+      ++dup_acks_;
+      if ( dup_acks_ == TCPConfig::DUP_ACK_THRESHOLD ) { // 快速重传 (丢的是探测数据段就不算拥塞)
+        if ( !is_probe( outstanding_segments.front() ) )
+          congestion_.on_fast_retransmit( in_flight(), next_seqno, now_ms_, !sacked_.empty() );
+        retransmit_front();
+      } else if ( dup_acks_ > TCPConfig::DUP_ACK_THRESHOLD ) { // 快速恢复：每个重复 ACK 说明又有一个数据段离开了网络
+        congestion_.on_duplicate_ack();
+      }
+    } else if ( new_data_acked ) {
+      dup_acks_ = 0;
+      if ( congestion_.in_recovery() ) { // NewReno 的部分确认：下一个空洞也丢了
+        retransmit_front();
+      }
+    }
+  }
+}
+
+void TCPSender::retransmit_front()
+{
+  if ( outstanding_segments.empty() ) {
+    return;
+  }
+  const auto& front = outstanding_segments.front();
+  if ( front.end() <= high_rxt_ ) { // 已经因为 SACK 重传过了
+    return;
+  }
+  retransmit( front );
+  high_rxt_ = front.end();
+}
+
+void TCPSender::retransmit( const Segment& segment )
+{
+  if ( segment.seqno >= released_seqno_ ) { // 还没发出过，已经在排队了
+    return;
+  }
+  if ( is_probe( segment ) ) { // 探测失败：这个大小通不过，数据由 split_front() 拆开重传
+    probe_high_ = segment.payload_size();
+    probe_high_set_ms_ = now_ms_;
+    probe_.reset();
+  }
+  // 排在还在等节奏控制的新数据前面，丢包恢复不用等它们发完
+  const auto new_data = find_if( queued_segments.begin(), queued_segments.end(), [&]( const Segment& queued ) {
+    return queued.seqno >= released_seqno_;
+  } );
+  queued_segments.insert( new_data, segment );
+  // Karn: 重传之后的 ACK 无法区分确认的是哪一次发送，放弃当前的 RTT 测量
+  rtt_timing_ = false;
+}
+
+void TCPSender::sample_rtt( uint64_t rtt_ms )
+{
+  const double rtt = static_cast<double>( rtt_ms );
+  if ( !rtt_measured_ ) { // RFC 6298 2.2
+    rtt_measured_ = true;
+    srtt_ms_ = rtt;
+    rttvar_ms_ = rtt / 2;
+  } else { // RFC 6298 2.3: alpha = 1/8, beta = 1/4
+    rttvar_ms_ = 0.75 * rttvar_ms_ + 0.25 * abs( srtt_ms_ - rtt );
+    srtt_ms_ = 0.875 * srtt_ms_ + 0.125 * rtt;
+  }
+
+  if ( adaptive_rto_ ) { // RTO = SRTT + max( G, 4 * RTTVAR )，时钟粒度 G 为 1 ms
+    const auto rto = static_cast<uint64_t>( ceil( srtt_ms_ + max( 1.0, 4 * rttvar_ms_ ) ) );
+    timer.setRTO( clamp( rto, rto_min_ms_, rto_max_ms_ ) );
+  }
+}
+
+void TCPSender::update_scoreboard( const TCPReceiverMessage& msg )
+{
+  // 丢掉已经被累计确认的部分
+  while ( !sacked_.empty() && sacked_.begin()->first < acked_seqno ) {
+    const auto end = sacked_.begin()->second;
+    sacked_.erase( sacked_.begin() );
+    if ( end > acked_seqno ) {
+      sacked_.emplace( acked_seqno, end );
+      break;
+    }
+  }
+
+  for ( const auto& block : msg.sack ) {
+    auto begin = block.left.unwrap( isn_, next_seqno );
+    auto end = block.right.unwrap( isn_, next_seqno );
+    if ( end > next_seqno || end <= acked_seqno || end <= begin ) { // 不合理的块直接忽略
+      continue;
+    }
+    begin = max( begin, acked_seqno );
+
+    // 与重叠或相邻的区间合并
+    auto it = sacked_.upper_bound( begin );
+    if ( it != sacked_.begin() && std::prev( it )->second >= begin ) {
+      --it;
+      begin = it->first;
+    }
+    while ( it != sacked_.end() && it->first <= end ) {
+      end = max( end, it->second );
+      it = sacked_.erase( it );
+    }
+    sacked_.emplace( begin, end );
+  }
+
+  sacked_cnt_ = 0;
+  for ( const auto& [begin, end] : sacked_ ) {
+    sacked_cnt_ += end - begin;
+  }
+}
+
+bool TCPSender::is_sacked( uint64_t begin, uint64_t end ) const
+{
+  auto it = sacked_.upper_bound( begin );
+  return it != sacked_.begin() && std::prev( it )->second >= end;
+}
+
+bool TCPSender::is_lost( uint64_t end ) const
+{
+  static constexpr uint64_t dup_thresh = 3;
+  uint64_t ranges_above = 0;
+  uint64_t sacked_above = 0;
+  for ( auto it = sacked_.rbegin(); it != sacked_.rend() && it->second > end; ++it ) {
+    ++ranges_above;
+    sacked_above += it->second - max( it->first, end );
+  }
+  return ranges_above >= dup_thresh || sacked_above > ( dup_thresh - 1 ) * mss_;
+}
+
+void TCPSender::retransmit_lost()
+{
+  for ( const auto& segment : outstanding_segments ) {
+    if ( segment.end() <= high_rxt_ || is_sacked( segment.seqno, segment.end() ) ) {
+      continue;
+    }
+    if ( !is_lost( segment.end() ) ) { // 后面的数据段之上被 SACK 的更少，也不会被判定丢失
+      break;
+    }
+    retransmit( segment );
+    high_rxt_ = segment.end();
   }
 }
 
@@ -129,12 +487,37 @@ void TCPSender::tick( const size_t ms_since_last_tick )
   // Your code here.
   // 自上次调用tick（）方法以来经过了多少毫秒
   timer.tick( ms_since_last_tick );
+  now_ms_ += ms_since_last_tick;
+
+  if ( const auto rate = pacing_rate(); rate > 0 ) {
+    // 长时间没有 tick 时不攒下超过一个桶的令牌，但这次 tick 补充的总能用完
+    const double added = static_cast<double>( rate * ms_since_last_tick ) / 1000;
+    pacing_credit_ = min( pacing_credit_ + added, max( added, pacing_burst() ) );
+  }
 
-  if ( timer.is_expired() ) {                             // 超时
-    queued_segments.push( outstanding_segments.front() ); // 重新发送
-    if ( window_size != 0 ) {
+  if ( mtu_probing_ && probe_high_ <= mss_limit_ && now_ms_ - probe_high_set_ms_ >= PMTU_RAISE_TIMER_MS ) {
+    probe_high_ = mss_limit_ + 1; // 路径可能变了：重新向上探测
+  }
+
+  if ( timer.is_expired() ) { // 超时
+    // 接收方可能已经丢弃了 SACK 过的数据 (RFC 2018 8, RFC 6675 5.1)：忘掉记分板，这些字节重新算在 pipe 里
+    sacked_.clear();
+    sacked_cnt_ = 0;
+    high_rxt_ = 0;
+    const bool probe_lost = is_probe( outstanding_segments.front() );
+    retransmit( outstanding_segments.front() ); // 重新发送
+    if ( window_size != 0 && !probe_lost ) {    // 探测数据段丢失不是拥塞，也不退避
       ++retransmit_cnt_;
-      timer.doubleRTO();
+      timer.doubleRTO( rto_max_ms_ );
+      congestion_.on_timeout( in_flight(), now_ms_ ); // 超时说明发生了拥塞
+
+      if ( mtu_probing_ && retransmit_cnt_ == BLACK_HOLE_RETRANSMISSIONS && mss_ > base_mss() ) {
+        // 黑洞检测 (RFC 8899 4.3)：路径可能已经通不过确认过的大小，退回基础大小重新搜索
+        probe_high_ = mss_;
+        probe_high_set_ms_ = now_ms_;
+        mss_ = base_mss();
+        congestion_.set_mss( mss_ );
+      }
     }
 
     timer.start(); // 重启计时器
@@ -1,13 +1,20 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <optional>
+
 class Timer
 {
 private:
-  uint64_t initial_RTO_ms_; // 初始重传超时时间
+  uint64_t initial_RTO_ms_; // 重传超时时间 (退避前)
   uint64_t current_RTO_ms;  // 当前重传超时时间
   uint64_t time_ms { 0 };   // 计时器时间
   bool running { false };   // 是否运行
@@ -15,6 +22,8 @@ private:
 public:
   explicit Timer( uint64_t init_ROT ) : initial_RTO_ms_( init_ROT ), current_RTO_ms( init_ROT ) {}
 
+  void setRTO( uint64_t RTO_ms ) { initial_RTO_ms_ = current_RTO_ms = RTO_ms; } // 新的 RTO (退避也一起清除)
+
   void stop() { running = false; } // 停止计时器
 
   void start() // 开始计时器
@@ -30,11 +39,18 @@ public:
     }
   }
 
-  bool is_running() { return running; }
+  bool is_running() const { return running; }
+
+  uint64_t remaining() const { return time_ms < current_RTO_ms ? current_RTO_ms - time_ms : 0; } // 距离过期还有多久
 
   bool is_expired() { return running && time_ms >= current_RTO_ms; } // 计时器是否过期
 
-  void doubleRTO() { current_RTO_ms *= 2; } // 重传超时时间翻倍
+  void doubleRTO( uint64_t max_RTO_ms = UINT64_MAX ) // 重传超时时间翻倍
+  {
+    current_RTO_ms = std::min( current_RTO_ms * 2, max_RTO_ms );
+  }
+
+  uint64_t RTO() const { return current_RTO_ms; }
 
   void resetRTO() { current_RTO_ms = initial_RTO_ms_; } // 重置重传超时时间
 };
@@ -50,19 +66,114 @@ class TCPSender
   uint64_t acked_seqno { 0 };     // 已确认的序列号
   uint64_t next_seqno { 0 };      // 下一个要发送的序列号
   uint64_t window_size { 1 };     // 窗口大小
+  uint8_t window_shift_ { 0 };    // 对方窗口的缩放位数 (RFC 7323)
   uint64_t outstanding_cnt { 0 }; // 发送中的数量
 
-  std::queue<TCPSenderMessage> outstanding_segments {}; // 发送中的队列 发送中未被确认的队列，还在“飞行”中的数据
+  // A segment by its sequence range. The payload is not copied: it stays retained in the outbound stream
+  // until acknowledged, and make_message() rebuilds it from there for each (re)transmission.
+  struct Segment
+  {
+    uint64_t seqno { 0 };  // 第一个序列号 (绝对)
+    uint64_t length { 0 }; // 占用的序列号数量 (包括 SYN 和 FIN)
+    bool SYN { false };
+    bool FIN { false };
+
+    uint64_t end() const { return seqno + length; }
+    uint64_t payload_size() const { return length - SYN - FIN; }
+  };
+
+  std::deque<Segment> outstanding_segments {}; // 发送中的队列 发送中未被确认的队列，还在“飞行”中的数据
   // Keep track of which segments have been sent but not yet acknowledged by the receiver
-  std::queue<TCPSenderMessage> queued_segments {}; // 缓存队列 准备发送的队列，发送数据从这里获取
+  std::deque<Segment> queued_segments {}; // 缓存队列 准备发送的队列，发送数据从这里获取
+  Reader* outbound_ { nullptr };          // push() 读取的流，未确认的字节保留在其中
+
+  TCPSenderMessage make_message( const Segment& segment ) const;
+
+  // Segment size. With PLPMTUD (RFC 8899), new segments start at the base size (MAX_PAYLOAD_SIZE), and one
+  // larger probe segment at a time tests whether the path carries more. A lost probe only lowers the search
+  // range (not the congestion window), and its data is resent in segments of the confirmed size.
+  static constexpr uint64_t PROBE_STEP = 32;                // 搜索范围小于这个就停止探测
+  static constexpr uint64_t PMTU_RAISE_TIMER_MS = 600000;   // 这么久没有探测失败，就重新向上探测 (RFC 8899 5.1.1)
+  static constexpr uint64_t BLACK_HOLE_RETRANSMISSIONS = 2; // 连续超时这么多次，就退回到基础大小
+  uint64_t mss_limit_ { TCPConfig::MAX_PAYLOAD_SIZE }; // 对方能接收的最大负载 (MSS 选项)
+  uint64_t mss_ { TCPConfig::MAX_PAYLOAD_SIZE };       // 新数据段的负载大小 (路径已确认能通过)
+  bool mtu_probing_ { false };
+  uint64_t probe_high_ { TCPConfig::MAX_PAYLOAD_SIZE + 1 }; // 探测失败过的最小负载 (没有失败过就是 mss_limit_ + 1)
+  uint64_t probe_high_set_ms_ { 0 };                        // probe_high_ 上次降低的时间
+  std::optional<Segment> probe_ {};                         // 正在飞行中的探测数据段
+
+  uint64_t base_mss() const { return std::min( TCPConfig::MAX_PAYLOAD_SIZE, mss_limit_ ); }
+  uint64_t next_probe_size() const; // 下一个探测数据段的负载 (0 表示现在不探测)
+  bool is_probe( const Segment& segment ) const { return probe_.has_value() && segment.seqno == probe_->seqno; }
+  void split_front(); // 把比 mss_ 大的重传数据段拆开
 
   Timer timer { initial_RTO_ms_ }; // 计时器
 
+  CongestionController congestion_; // 拥塞窗口
+  uint64_t now_ms_ { 0 };           // 累计经过的时间 (tick)
+
+  // SACK scoreboard: ranges [begin, end) of absolute sequence numbers above acked_seqno that the receiver holds
+  std::map<uint64_t, uint64_t> sacked_ {};
+  uint64_t sacked_cnt_ { 0 }; // 被 SACK 确认的序列号数量
+  uint64_t high_rxt_ { 0 };   // 因 SACK 判定丢失而重传到的位置 (RFC 6675 HighRxt)
+
+  void update_scoreboard( const TCPReceiverMessage& msg );
+  bool is_sacked( uint64_t begin, uint64_t end ) const;
+  bool is_lost( uint64_t end ) const; // RFC 6675 IsLost: enough has been SACKed above `end`
+  void retransmit_lost();             // 重传被判定丢失的空洞 (每个一次)
+
+  // 按节奏发送时，push() 排好的新数据段要等 maybe_send() 放行才算发出：在那之前不算在飞行中，也不计时
+  // (不按节奏时 maybe_send() 紧接着 push() 就把它们都发出去了)
+  uint64_t unsent_cnt() const { return pacing_ ? next_seqno - std::max( released_seqno_, acked_seqno ) : 0; }
+  uint64_t in_flight() const { return outstanding_cnt - unsent_cnt(); }
+
+  uint64_t dup_acks_ { 0 }; // 连续收到的重复 ACK 数量
+  void retransmit_front();  // 快速重传第一个未确认的数据段
+
+  // RTT estimation (RFC 6298): one segment at a time is timed, and never one that was retransmitted (Karn)
+  bool adaptive_rto_ { false };        // RTO 是否由 RTT 样本得出 (否则固定为初始值)
+  uint64_t rto_min_ms_ { 0 };          // RTO 的下限
+  uint64_t rto_max_ms_ { UINT64_MAX }; // RTO (包括退避) 的上限
+  double srtt_ms_ { 0 };               // 平滑 RTT
+  double rttvar_ms_ { 0 };             // RTT 的平均偏差
+  bool rtt_measured_ { false };        // 是否已经有过 RTT 样本
+  bool rtt_timing_ { false };          // 是否正在为一个数据段计时
+  uint64_t rtt_timed_end_ { 0 };       // 被计时数据段的结束序列号
+  uint64_t rtt_timed_at_ms_ { 0 };     // 被计时数据段的发送时间
+  uint64_t released_seqno_ { 0 };      // maybe_send() 已经发出过的最大序列号
+
+  // With timestamps (RFC 7323) every ACK of new data echoes when the segment that prompted it was sent,
+  // so each one gives an RTT sample, retransmitted or not
+  bool timestamps_ { false }; // 是否给每个数据段加上时间戳
+
+  void sample_rtt( uint64_t rtt_ms );
+  void retransmit( const Segment& segment ); // 重传一个数据段 (它的 RTT 不再能测量)
+
+  // Pacing: a token bucket of sequence numbers, refilled by tick() at pacing_rate() and spent by maybe_send()
+  bool pacing_ { false };
+  uint64_t configured_pacing_rate_ { 0 };    // 配置的速率 (字节/秒)，0 表示由 cwnd / SRTT 得出
+  double pacing_credit_ { pacing_burst() }; // 现在还能发送多少序列号
+
+  // 桶的深度 (两次 tick 之间的补充除外)：两个数据段，但至少要能付得起最大的数据段 (带 SYN 和 FIN 的探测)，
+  // 否则它永远发不出去
+  double pacing_burst() const { return static_cast<double>( std::max( 2 * mss_, mss_limit_ + 2 ) ); }
+  uint64_t pacing_cost( const Segment& segment ) const; // maybe_send() 发出它 (被 split_front() 拆开之后) 花掉的令牌
+
 public:
   /* Construct TCP sender with given default Retransmission Timeout and possible isn_ */
   TCPSender( uint64_t initial_RTO_ms_, std::optional<Wrap32> fixed_isn_ );
 
-  /* Push bytes from the outbound stream */
+  /* Construct TCP sender from a TCPConfig (rt_timeout, fixed_isn and congestion_control) */
+  explicit TCPSender( const TCPConfig& config );
+
+  /* A copy keeps reading the retained bytes of the same outbound stream, until push() is given another one */
+  TCPSender( const TCPSender& other ) = default;
+  TCPSender& operator=( const TCPSender& other ) = default;
+  TCPSender( TCPSender&& other ) = default;
+  TCPSender& operator=( TCPSender&& other ) = default;
+  ~TCPSender() = default;
+
+  /* Push bytes from the outbound stream (which must outlive the sender: it retains the unacknowledged bytes) */
   void push( Reader& outbound_stream );
 
   /* Send a TCPSenderMessage if needed (or empty optional otherwise) */
@@ -71,13 +182,33 @@ public:
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage send_empty_message() const;
 
-  /* Receive an act on a TCPReceiverMessage from the peer's receiver */
-  void receive( const TCPReceiverMessage& msg );
+  /* Receive an act on a TCPReceiverMessage from the peer's receiver. Only a `pure_ack` (one whose segment
+     carried no data, SYN or FIN) can count as a duplicate ACK (RFC 5681 2). */
+  void receive( const TCPReceiverMessage& msg, bool pure_ack = true );
+
+  /* The peer accepts payloads of up to `mss` bytes (its MSS option, less the space our options take) */
+  void set_mss( uint64_t mss );
+
+  /* Received windows are in units of 2^shift bytes (negotiated with the window scale option) */
+  void set_window_scale( uint8_t shift ) { window_shift_ = shift; }
 
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called. */
   void tick( uint64_t ms_since_last_tick );
 
+  /* Milliseconds until tick() next has something to do (the RTO expiring, or the pacer affording the next
+     segment), or empty if nothing is timed. Until then ticks may be deferred and batched, so a driver of many
+     connections can arm one deadline each on a TimerWheel instead of ticking them all. */
+  std::optional<uint64_t> next_deadline() const;
+
   /* Accessors for use in testing */
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  uint64_t congestion_window() const;           // Congestion window, in sequence numbers (UINT64_MAX if none)
+  uint64_t slow_start_threshold() const;        // Slow-start threshold, in sequence numbers
+  uint64_t smoothed_rtt() const;                // SRTT in milliseconds (0 before the first sample)
+  uint64_t rtt_variation() const;               // RTTVAR in milliseconds
+  uint64_t retransmission_timeout() const;      // Current RTO in milliseconds, including any backoff
+  uint64_t pacing_rate() const;                 // Bytes per second maybe_send() releases (0 if not pacing)
+  uint64_t max_segment_size() const;            // Largest payload the peer accepts
+  uint64_t segment_size() const;                // Payload size of new segments (PLPMTUD probes may be larger)
 };
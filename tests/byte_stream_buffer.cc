@@ -0,0 +1,139 @@
+#include "byte_stream.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+static void check( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "byte_stream_buffer: " + what );
+  }
+}
+
+int main()
+{
+  try {
+    const string first( 100, 'a' );
+    const string second = string( 50, 'b' ) + string( 50, 'c' );
+
+    {
+      // Buffer slices share storage until one of them is modified
+      const Buffer whole { first + second };
+      const Buffer slice = whole.substr( 100, 50 );
+      check( string_view { slice } == string( 50, 'b' ), "substr() has the wrong bytes" );
+      check( string_view { slice }.data() == string_view { whole }.data() + 100, "substr() copied" );
+      check( slice.substr( 10, 5 ).size() == 5, "slice of a slice has the wrong size" );
+
+      Buffer modified = slice;
+      static_cast<string&>( modified ).append( "!" );
+      check( string_view { modified } == string( 50, 'b' ) + "!", "modifying a slice lost its bytes" );
+      check( string_view { slice } == string( 50, 'b' ), "modifying a copy changed the slice" );
+      check( string_view { whole } == first + second, "modifying a slice changed the shared storage" );
+    }
+
+    {
+      // Chunked: a read within one chunk is a slice of the pushed string
+      ByteStream stream { 1000, ByteStream::Storage::Chunked };
+      stream.writer().push( first );
+      stream.writer().push( second );
+      const char* const chunk = stream.reader().peek().data();
+
+      Buffer payload;
+      read( stream.reader(), 60, payload );
+      check( string_view { payload } == first.substr( 0, 60 ), "read() into a Buffer has the wrong bytes" );
+      check( string_view { payload }.data() == chunk, "read() within a chunk copied" );
+
+      // the slice outlives the chunk being popped
+      Buffer rest;
+      read( stream.reader(), 40, rest );
+      read( stream.reader(), 100, rest );
+      check( stream.reader().bytes_buffered() == 0, "read() did not pop" );
+      check( string_view { rest } == second, "read() of a whole chunk has the wrong bytes" );
+      check( string_view { payload } == first.substr( 0, 60 ), "slice changed after pop()" );
+
+      // a read across chunks has to copy
+      stream.writer().push( first );
+      stream.writer().push( second );
+      read( stream.reader(), 150, payload );
+      check( string_view { payload } == first + second.substr( 0, 50 ), "read() across chunks has the wrong bytes" );
+    }
+
+    {
+      // Ring: always a copy
+      ByteStream stream { 150 };
+      stream.writer().push( first );
+      Buffer payload;
+      read( stream.reader(), 60, payload );
+      stream.writer().push( second );
+      check( string_view { payload } == first.substr( 0, 60 ), "read() from a ring has the wrong bytes" );
+      read( stream.reader(), 1000, payload );
+      check( string_view { payload } == first.substr( 60 ) + second, "ring read() is wrong" );
+    }
+
+    for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+      // retained bytes survive pop() and keep using capacity until released
+      ByteStream stream { 250, storage };
+      stream.reader().retain( true );
+      stream.writer().push( first );
+      stream.writer().push( second );
+      stream.reader().pop( 120 );
+      check( stream.reader().bytes_retained() == 120, "pop() did not retain" );
+      check( stream.writer().available_capacity() == 50, "retained bytes do not use capacity" );
+      check( string_view { stream.reader().peek_retained( 90, 30 ) } == first.substr( 90 ) + second.substr( 0, 20 ),
+             "peek_retained() across the chunks is wrong" );
+      if ( storage == ByteStream::Storage::Chunked ) {
+        const Buffer whole = stream.reader().peek_retained( 0, 100 );
+        const Buffer slice = stream.reader().peek_retained( 10, 50 );
+        check( string_view { slice }.data() == string_view { whole }.data() + 10,
+               "peek_retained() within a chunk copied" );
+      }
+
+      stream.reader().release( 110 );
+      check( stream.reader().bytes_retained() == 10, "release() is wrong" );
+      check( stream.writer().available_capacity() == 160, "release() did not free capacity" );
+      check( string_view { stream.reader().peek_retained( 0, 100 ) } == second.substr( 10, 10 ),
+             "peek_retained() after release() is wrong" );
+
+      stream.writer().push( first + second );
+      stream.reader().pop( 1000 );
+      check( string_view { stream.reader().peek_retained( 10, 240 ) }
+               == second.substr( 20 ) + first + second.substr( 0, 60 ),
+             "peek_retained() after wrapping is wrong" );
+
+      stream.reader().retain( false );
+      check( stream.reader().bytes_retained() == 0 and stream.writer().available_capacity() == 250,
+             "retain( false ) did not release" );
+    }
+
+    {
+      // set_capacity() keeps the retained bytes and those written ahead with write_reserved()
+      ByteStream stream { 12 };
+      stream.reader().retain( true );
+      stream.writer().push( "abcdef" );
+      stream.reader().pop( 4 );
+      stream.writer().write_reserved( 2, "xy" );
+      stream.writer().set_capacity( 16 );
+      check( stream.capacity() == 16 and stream.writer().available_capacity() == 10,
+             "set_capacity() did not grow the stream" );
+      check( string_view { stream.reader().peek_retained( 0, 4 ) } == "abcd",
+             "set_capacity() lost retained bytes" );
+      stream.writer().write_reserved( 0, "gh" );
+      stream.writer().commit( 4 );
+      check( stream.reader().peek() == "efghxy", "set_capacity() lost reserved bytes" );
+
+      stream.writer().set_capacity( 1 );
+      check( stream.capacity() == 10, "set_capacity() shrank below the bytes held" );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
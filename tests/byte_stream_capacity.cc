@@ -97,6 +97,37 @@ int main()
       test.execute( BytesBuffered { 1 } );
     }
 
+    {
+      ByteStreamTestHarness test { "grow while wrapped", 4 };
+      test.execute( Push { "abcd" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "efg" } ); // wraps around the ring
+      test.execute( SetCapacity { 10 } );
+      test.execute( Capacity { 10 } );
+      test.execute( AvailableCapacity { 6 } );
+      test.execute( Push { "hijklmno" } );
+      test.execute( BytesBuffered { 10 } );
+      test.execute( ReadAll { "defghijklm" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "shrink", 8 };
+      test.execute( Push { "abcdef" } );
+      test.execute( Pop { 5 } );
+      test.execute( Push { "ghij" } );
+      test.execute( SetCapacity { 3 } ); // no lower than the bytes held
+      test.execute( Capacity { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Push { "k" } );
+      test.execute( Pop { 2 } );
+      test.execute( Push { "lmn" } );
+      test.execute( ReadAll { "hijlm" } );
+      test.execute( SetCapacity { 2 } );
+      test.execute( Capacity { 2 } );
+      test.execute( Push { "opq" } );
+      test.execute( ReadAll { "op" } );
+    }
+
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <queue>
 #include <random>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
@@ -15,7 +16,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t read_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const ByteStream::Storage storage )
 {
   // Generate the data to be written
   const string data = [&random_seed, &input_len] {
@@ -34,10 +36,16 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
     split_data.emplace( data.substr( i, write_size ) );
   }
 
-  ByteStream bs { capacity };
+  ByteStream bs { capacity, storage };
   string output_data;
   output_data.reserve( data.size() );
 
+  // Where each pushed string's bytes lived (stream offset, address), to tell whether
+  // peek() handed them back in place or the stream had copied them.
+  vector<pair<uint64_t, uintptr_t>> origins;
+  size_t origin_idx = 0;
+  uint64_t bytes_copied = 0;
+
   const auto start_time = steady_clock::now();
   while ( not bs.reader().is_finished() ) {
     if ( split_data.empty() ) {
@@ -46,6 +54,7 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
       }
     } else {
       if ( split_data.front().size() <= bs.writer().available_capacity() ) {
+        origins.emplace_back( bs.writer().bytes_pushed(), reinterpret_cast<uintptr_t>( split_data.front().data() ) );
         bs.writer().push( move( split_data.front() ) );
         split_data.pop();
       }
@@ -56,6 +65,14 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
       if ( peeked.empty() ) {
         throw runtime_error( "ByteStream::reader().peek() returned empty view" );
       }
+      const uint64_t offset = bs.reader().bytes_popped();
+      while ( origin_idx + 1 < origins.size() and origins[origin_idx + 1].first <= offset ) {
+        ++origin_idx;
+      }
+      if ( reinterpret_cast<uintptr_t>( peeked.data() )
+           != origins[origin_idx].second + ( offset - origins[origin_idx].first ) ) {
+        bytes_copied += peeked.size();
+      }
       output_data += peeked;
       bs.reader().pop( peeked.size() );
     }
@@ -75,8 +92,11 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "ByteStream with capacity=" << capacity << ", write_size=" << write_size << ", read_size=" << read_size
-       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+  const auto copies_per_byte = static_cast<double>( bytes_copied ) / static_cast<double>( input_len );
+
+  cout << ( storage == ByteStream::Storage::Ring ? "Ring" : "Chunked" ) << " ByteStream with capacity=" << capacity
+       << ", write_size=" << write_size << ", read_size=" << read_size << " reached " << fixed << setprecision( 2 )
+       << gigabits_per_second << " Gbit/s, copying " << copies_per_byte << " bytes per byte delivered.\n";
 
   debug_output << "             ByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
                << " Gbit/s\n";
@@ -88,7 +108,16 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
 
 void program_body()
 {
-  speed_test( 1e7, 32768, 789, 1500, 128 );
+  for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+    speed_test( 1e7, 32768, 789, 1500, 128, storage );
+
+    // small reads against large capacities: each pop must not move the rest of the buffer
+    speed_test( 1e7, 65536, 789, 1500, 16, storage );
+    speed_test( 1e7, 1048576, 789, 4096, 64, storage );
+
+    // right-sized reads, as from a socket write of the whole peek()
+    speed_test( 1e7, 65536, 789, 1500, 65536, storage );
+  }
 }
 
 int main()
@@ -13,11 +13,18 @@ static_assert( sizeof( Reader ) == sizeof( ByteStream ),
 static_assert( sizeof( Writer ) == sizeof( ByteStream ),
                "Please add member variables to the ByteStream base, not the ByteStream Writer." );
 
+// The byte_stream_* tests are also built with BYTE_STREAM_TEST_STORAGE=Chunked (see tests/CMakeLists.txt)
+#ifndef BYTE_STREAM_TEST_STORAGE
+#define BYTE_STREAM_TEST_STORAGE Ring
+#endif
+
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
+  static constexpr ByteStream::Storage storage = ByteStream::Storage::BYTE_STREAM_TEST_STORAGE;
+
   ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity, storage } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
@@ -55,6 +62,15 @@ struct Pop : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.reader().pop( len_ ); }
 };
 
+struct SetCapacity : public Action<ByteStream>
+{
+  uint64_t capacity_;
+
+  explicit SetCapacity( uint64_t capacity ) : capacity_( capacity ) {}
+  std::string description() const override { return "set_capacity( " + std::to_string( capacity_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.writer().set_capacity( capacity_ ); }
+};
+
 /* expectations */
 
 struct Peek : public Expectation<ByteStream>
@@ -107,6 +123,28 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekIov : public Peek
+{
+  using Peek::Peek;
+
+  std::string description() const override { return "peek_iov() gives \"" + Printer::prettify( output_ ) + "\""; }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got;
+    for ( const auto region : bs.reader().peek_iov() ) {
+      if ( region.empty() ) {
+        throw ExpectationViolation { "Reader::peek_iov() returned an empty region" };
+      }
+      got += region;
+    }
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\" from peek_iov(), "
+                                   + "but found \"" + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
@@ -149,6 +187,13 @@ struct AvailableCapacity : public ExpectNumber<ByteStream, uint64_t>
   size_t value( ByteStream& bs ) const override { return bs.writer().available_capacity(); }
 };
 
+struct Capacity : public ExpectNumber<ByteStream, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "capacity"; }
+  size_t value( ByteStream& bs ) const override { return bs.capacity(); }
+};
+
 struct BytesPushed : public ExpectNumber<ByteStream, uint64_t>
 {
   using ExpectNumber::ExpectNumber;
@@ -0,0 +1,168 @@
+#include "byte_stream.hh"
+#include "checksum.hh"
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Every InternetChecksum kernel the CPU supports gives the same checksum as the byte-at-a-time one, for any
+// length, alignment and split of the data into Buffers
+
+namespace {
+
+using Kernel = InternetChecksum::Kernel;
+const vector<Kernel> kernels { Kernel::Scalar, Kernel::Word, Kernel::SSE2, Kernel::AVX2 };
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "InternetChecksum: " + what );
+  }
+}
+
+uint16_t checksum( const vector<Buffer>& data, Kernel kernel, uint32_t initial = 0 )
+{
+  InternetChecksum check { initial, kernel };
+  check.add( data );
+  return check.value();
+}
+
+// The example of RFC 1071 4.1
+void known_answer_test()
+{
+  const string data { "\x00\x01\xf2\x03\xf4\xf5\xf6\xf7", 8 };
+  for ( const auto kernel : kernels ) {
+    if ( InternetChecksum::supported( kernel ) ) {
+      expect( InternetChecksum::partial_sum( data, kernel ) == 0xddf2, "wrong sum of the RFC 1071 example" );
+      expect( checksum( { data }, kernel ) == 0x220d, "wrong checksum of the RFC 1071 example" );
+    }
+  }
+}
+
+void random_test()
+{
+  auto rd = get_random_engine();
+  uniform_int_distribution<size_t> length_dist { 0, 3000 };
+  uniform_int_distribution<size_t> offset_dist { 0, 31 };
+  uniform_int_distribution<uint32_t> initial_dist { 0, UINT32_MAX };
+  uniform_int_distribution<int> byte_dist { 0, 255 };
+
+  for ( int i = 0; i < 2000; ++i ) {
+    // a Buffer that starts at a random alignment, split at random (often odd) points
+    string bytes( offset_dist( rd ) + length_dist( rd ), '\0' );
+    generate( bytes.begin(), bytes.end(), [&] { return static_cast<char>( byte_dist( rd ) ); } );
+    const Buffer whole { bytes };
+    const size_t offset = offset_dist( rd ) % ( bytes.size() + 1 );
+    vector<Buffer> pieces;
+    for ( size_t pos = offset; pos < bytes.size(); ) {
+      const size_t len = min( bytes.size() - pos, length_dist( rd ) % 200 + 1 );
+      pieces.push_back( whole.substr( pos, len ) );
+      pos += len;
+    }
+
+    const uint32_t initial = initial_dist( rd );
+    const uint16_t expected = checksum( pieces, Kernel::Scalar, initial );
+    expect( checksum( { whole.substr( offset ) }, Kernel::Scalar, initial ) == expected,
+            "splitting the data changes the checksum" );
+    for ( const auto kernel : kernels ) {
+      if ( InternetChecksum::supported( kernel ) ) {
+        const string what = "kernel " + to_string( static_cast<int>( kernel ) ) + ", for "
+                            + to_string( bytes.size() - offset ) + " bytes in " + to_string( pieces.size() )
+                            + " pieces";
+        expect( checksum( pieces, kernel, initial ) == expected, what + ": wrong checksum" );
+
+        // the same, copying the pieces one after the other
+        InternetChecksum check { initial, kernel };
+        string copy( bytes.size() - offset, '\0' );
+        size_t copied = 0;
+        for ( const auto& piece : pieces ) {
+          check.copy_and_add( copy.data() + copied, piece );
+          copied += piece.size();
+        }
+        expect( check.value() == expected, what + ": wrong checksum while copying" );
+        expect( copy == string_view { bytes }.substr( offset ), what + ": wrong copy" );
+      }
+    }
+  }
+}
+
+// Long runs of 0xff make the vector kernels' lanes as full as they get before they are added up
+void long_test()
+{
+  const string ones( 3 << 20, '\xff' );
+  for ( const auto kernel : kernels ) {
+    if ( InternetChecksum::supported( kernel ) ) {
+      for ( const size_t len : { ones.size(), ones.size() - 1 } ) {
+        expect( InternetChecksum::partial_sum( string_view { ones }.substr( 0, len ), kernel )
+                  == InternetChecksum::partial_sum( string_view { ones }.substr( 0, len ), Kernel::Scalar ),
+                "kernel " + to_string( static_cast<int>( kernel ) ) + " disagrees on a long run of 0xff" );
+      }
+    }
+  }
+}
+
+// A segment's checksum is the same whether it reuses the payload sum the sender took as it copied the
+// payload out of the stream, or reads the payload again; and the receiving side verifies it
+void segment_test()
+{
+  for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+    TCPConfig cfg;
+    cfg.fixed_isn = Wrap32 { 12345 };
+    TCPSender sender { cfg };
+    ByteStream stream { 1000, storage };
+    for ( const string_view piece : { "abc", "defgh", "ijklmnopq" } ) { // segments span odd-sized chunks
+      stream.writer().push( string { piece } );
+    }
+    const auto check_segments = [&] {
+      sender.push( stream.reader() );
+      while ( const auto msg = sender.maybe_send() ) {
+        expect( msg->payload.empty() or msg->payload_sum.has_value(), "sender didn't sum the payload" );
+        TCPSegment seg { *msg, {} };
+        seg.compute_checksum( 0x1234 );
+        TCPSegment again = seg;
+        again.sender_message.payload_sum.reset();
+        again.compute_checksum( 0x1234 );
+        expect( seg.udinfo.cksum == again.udinfo.cksum, "payload sum gives a different segment checksum" );
+
+        TCPSegment parsed;
+        expect( parse( parsed, serialize( seg ), 0x1234 ), "segment with a fused checksum fails to verify" );
+      }
+    };
+
+    check_segments(); // SYN
+    sender.receive( { Wrap32 { 12346 }, 7 } );
+    check_segments(); // 7 bytes, across chunks
+    sender.receive( { Wrap32 { 12353 }, 1000 } );
+    stream.writer().push( string( 995, 'x' ) );
+    check_segments(); // across the end of the ring
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    known_answer_test();
+    random_test();
+    long_test();
+    segment_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+#include "byte_stream.hh"
+#include "checksum.hh"
+#include "ipv4_header.hh"
+#include "tcp_segment.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+// What checksumming costs per byte with each InternetChecksum kernel the CPU supports, for a header, a
+// full-size segment and a large buffer. Then, with the fastest kernel, what copying and checksumming costs
+// per byte in two passes and fused into one, alone and for building a segment from a ByteStream (the
+// sender's peek_retained() and TCPSegment::compute_checksum). Last, what a router's TTL decrement costs per
+// datagram header when it computes the checksum again, or patches it (IPv4Header::decrement_ttl). Prints CSV.
+
+namespace {
+
+using Kernel = InternetChecksum::Kernel;
+
+constexpr uint64_t BYTES_PER_RUN = 256 << 20;
+volatile uint16_t sink; // keeps the checksums from being optimized away
+
+const char* name( Kernel kernel )
+{
+  switch ( kernel ) {
+    case Kernel::Scalar:
+      return "scalar";
+    case Kernel::Word:
+      return "word";
+    case Kernel::SSE2:
+      return "sse2";
+    case Kernel::AVX2:
+      return "avx2";
+  }
+  return "?";
+}
+
+void report( const string& what, size_t size, uint64_t reps, steady_clock::time_point start )
+{
+  const double ns = duration_cast<duration<double, nano>>( steady_clock::now() - start ).count();
+  const double bytes = static_cast<double>( reps * size );
+  cout << what << "," << size << "," << fixed << setprecision( 3 ) << ns / bytes << "," << setprecision( 2 )
+       << bytes / ns << "\n";
+}
+
+void speed_test( Kernel kernel, size_t size )
+{
+  const string data( size, 'x' );
+  if ( InternetChecksum::partial_sum( data, kernel ) != InternetChecksum::partial_sum( data, Kernel::Scalar ) ) {
+    throw runtime_error( string { name( kernel ) } + " kernel disagrees with the scalar one" );
+  }
+
+  const uint64_t reps = BYTES_PER_RUN / size / ( kernel == Kernel::Scalar ? 8 : 1 );
+  uint16_t result = 0;
+
+  const auto start = steady_clock::now();
+  for ( uint64_t i = 0; i < reps; ++i ) {
+    InternetChecksum check { static_cast<uint32_t>( i ), kernel };
+    check.add( data );
+    result ^= check.value();
+  }
+  report( name( kernel ), size, reps, start );
+  sink = result;
+}
+
+void copy_test( bool fused, size_t size )
+{
+  const string data( size, 'x' );
+  string copy( size, '\0' );
+  const uint64_t reps = BYTES_PER_RUN / size;
+  const Kernel kernel = InternetChecksum::fastest();
+
+  const auto start = steady_clock::now();
+  for ( uint64_t i = 0; i < reps; ++i ) {
+    if ( fused ) {
+      sink = InternetChecksum::copy_and_sum( copy.data(), data, kernel );
+    } else {
+      memcpy( copy.data(), data.data(), size );
+      sink = InternetChecksum::partial_sum( copy, kernel );
+    }
+  }
+  report( fused ? "copy_and_sum" : "copy_then_sum", size, reps, start );
+}
+
+// A payload copied out of a (wrapped) ring of retained bytes, then its segment checksummed
+void segment_test( bool fused, size_t size )
+{
+  ByteStream stream { 2 * size };
+  stream.reader().retain( true );
+  stream.writer().push( string( size + 1, 'y' ) );
+  stream.reader().pop( size + 1 );
+  stream.reader().release( size + 1 );
+  stream.writer().push( string( size, 'x' ) );
+  stream.reader().pop( size );
+  const uint64_t reps = BYTES_PER_RUN / size;
+
+  const auto start = steady_clock::now();
+  for ( uint64_t i = 0; i < reps; ++i ) {
+    TCPSegment seg;
+    if ( fused ) {
+      InternetChecksum payload_sum;
+      seg.sender_message.payload = stream.reader().peek_retained( 0, size, &payload_sum );
+      seg.sender_message.payload_sum = payload_sum.sum();
+    } else {
+      seg.sender_message.payload = stream.reader().peek_retained( 0, size );
+    }
+    seg.compute_checksum( 0 );
+    sink = seg.udinfo.cksum;
+  }
+  report( fused ? "tcp_segment_fused" : "tcp_segment_two_pass", size, reps, start );
+}
+
+void ttl_test( bool incremental )
+{
+  constexpr uint64_t reps = 10'000'000;
+  IPv4Header header;
+  header.len = 1500;
+  header.compute_checksum();
+
+  const auto start = steady_clock::now();
+  for ( uint64_t i = 0; i < reps; ++i ) {
+    if ( header.ttl == 1 ) {
+      header.ttl = IPv4Header::DEFAULT_TTL;
+      header.compute_checksum();
+    }
+    if ( incremental ) {
+      header.decrement_ttl();
+    } else {
+      header.ttl--;
+      header.compute_checksum();
+    }
+  }
+  report( incremental ? "ipv4_ttl_incremental" : "ipv4_ttl_recompute", IPv4Header::LENGTH, reps, start );
+  sink = header.cksum;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    cout << "kernel,bytes,ns_per_byte,GBps\n";
+    for ( const size_t size : { 20UL, 1460UL, 64UL << 10 } ) {
+      for ( const auto kernel : { Kernel::Scalar, Kernel::Word, Kernel::SSE2, Kernel::AVX2 } ) {
+        if ( InternetChecksum::supported( kernel ) ) {
+          speed_test( kernel, size );
+        }
+      }
+    }
+    for ( const size_t size : { 1460UL, 64UL << 10 } ) {
+      copy_test( false, size );
+      copy_test( true, size );
+    }
+    for ( const size_t size : { 1460UL, 16UL << 10 } ) {
+      segment_test( false, size );
+      segment_test( true, size );
+    }
+    ttl_test( false );
+    ttl_test( true );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#include "header_layout.hh"
+#include "ipv4_header.hh"
+#include "parser.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "HeaderLayout: " + what );
+  }
+}
+
+string concat( const vector<Buffer>& buffers )
+{
+  string all;
+  for ( const auto& buf : buffers ) {
+    all.append( buf );
+  }
+  return all;
+}
+
+// An 802.1Q VLAN tag: fields of 3, 1 and 12 bits share two bytes
+struct VLANTag
+{
+  uint8_t pcp {};  // priority
+  bool dei {};     // drop eligible
+  uint16_t vid {}; // VLAN id
+  uint16_t type {};
+};
+
+using VLANLayout = HeaderLayout<HeaderField<&VLANTag::pcp, 0, 3>,
+                                HeaderField<&VLANTag::dei, 3, 1>,
+                                HeaderField<&VLANTag::vid, 4, 12>,
+                                HeaderField<&VLANTag::type, 16, 16>>;
+
+void bitfield_test()
+{
+  static_assert( VLANLayout::LENGTH == 4 );
+
+  const VLANTag tag { 5, true, 0xabc, 0x0800 };
+  Serializer serializer;
+  VLANLayout::serialize( tag, serializer );
+  expect( concat( serializer.output() ) == string( "\xba\xbc\x08\x00", 4 ), "VLAN tag serialized wrong" );
+
+  VLANTag parsed;
+  Parser parser { { string( "\xba\xbc\x08\x00", 4 ) } };
+  VLANLayout::parse( parsed, parser );
+  expect( not parser.has_error(), "VLAN tag failed to parse" );
+  expect( parsed.pcp == 5 and parsed.dei and parsed.vid == 0xabc and parsed.type == 0x0800,
+          "VLAN tag parsed wrong" );
+
+  // values too wide for their field are cut to its bits, and don't spill into their neighbours
+  const VLANTag wide { 0xff, false, 0xffff, 0 };
+  expect( VLANLayout::to_bytes( wide ) == VLANLayout::Bytes { '\xef', '\xff', 0, 0 }, "wide values spilled" );
+
+  // a header split across Buffers, and a short one
+  Parser split { { string( "\xba" ), string( "\xbc\x08" ), string( "\x00", 1 ) } };
+  VLANLayout::parse( parsed, split );
+  expect( not split.has_error() and parsed.vid == 0xabc, "VLAN tag across Buffers" );
+  Parser short_input { { string( "\xba\xbc\x08" ) } };
+  VLANLayout::parse( parsed, short_input );
+  expect( short_input.has_error(), "short VLAN tag parsed" );
+}
+
+// The IPv4 header's bitfields land where RFC 791 puts them
+void ipv4_test()
+{
+  IPv4Header header;
+  header.tos = 0x12;
+  header.len = 0x0456;
+  header.id = 0x789a;
+  header.df = false;
+  header.mf = true;
+  header.offset = 0x1bcd;
+  header.ttl = 64;
+  header.proto = 17;
+  header.src = 0x0a000001;
+  header.dst = 0xc0a80102;
+  header.compute_checksum();
+
+  const string wire = concat( serialize( header ) );
+  expect( wire.size() == IPv4Header::LENGTH, "IPv4 header length" );
+  expect( wire.substr( 0, 8 ) == string( "\x45\x12\x04\x56\x78\x9a\x3b\xcd", 8 ), "IPv4 bitfields" );
+  expect( wire.substr( 8, 2 ) == "\x40\x11", "IPv4 TTL and protocol" );
+  expect( wire.substr( 12 ) == string( "\x0a\x00\x00\x01\xc0\xa8\x01\x02", 8 ), "IPv4 addresses" );
+
+  IPv4Header parsed;
+  expect( parse( parsed, { wire } ), "IPv4 header failed to parse" );
+  expect( not parsed.df and parsed.mf and parsed.offset == 0x1bcd and parsed.cksum == header.cksum
+            and parsed.src == header.src and parsed.dst == header.dst,
+          "IPv4 header parsed wrong" );
+}
+
+// The TCP flags and data offset share bytes 12 and 13
+void tcp_test()
+{
+  TCPSegment seg;
+  seg.udinfo.src_port = 1234;
+  seg.udinfo.dst_port = 80;
+  seg.sender_message.seqno = Wrap32 { 0x01020304 };
+  seg.sender_message.SYN = true;
+  seg.receiver_message.ackno = Wrap32 { 0x05060708 };
+  seg.receiver_message.window_size = 0x1000;
+  seg.mss = 1460;
+  seg.compute_checksum( 0 );
+
+  const string wire = concat( serialize( seg ) );
+  expect( wire.size() == 24, "TCP header with an MSS option" );
+  expect( wire.substr( 4, 10 ) == string( "\x01\x02\x03\x04\x05\x06\x07\x08\x60\x12", 10 ), "TCP fixed header" );
+
+  TCPSegment parsed;
+  expect( parse( parsed, { wire }, 0 ), "TCP segment failed to parse" );
+  expect( parsed.sender_message.SYN and not parsed.sender_message.FIN and not parsed.reset
+            and parsed.receiver_message.ackno == Wrap32 { 0x05060708 } and parsed.mss == 1460,
+          "TCP segment parsed wrong" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    bitfield_test();
+    ipv4_test();
+    tcp_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -320,6 +320,26 @@ int main()
         serialize( make_arp( ARPMessage::OPCODE_REQUEST, local_eth, "10.0.0.1", {}, "10.0.0.5" ) ) ) } );
       test.execute( ExpectNoFrame {} );
     }
+    {
+      const EthernetAddress local_eth = random_private_ethernet_address();
+      NetworkInterfaceTestHarness test {
+        "datagrams larger than the MTU are dropped", local_eth, Address( "1.2.3.4", 0 ), 100 };
+
+      InternetDatagram big = make_datagram( "5.6.7.8", "13.12.11.10" );
+      big.payload.front() = string( 81, 'x' );
+      big.header.len = static_cast<uint64_t>( big.header.hlen ) * 4 + 81;
+      big.header.compute_checksum();
+      test.execute( SendDatagram { big, Address( "192.168.0.1", 0 ) } );
+      test.execute( ExpectNoFrame {} );
+
+      test.execute( SendDatagram { make_datagram( "5.6.7.8", "13.12.11.10" ), Address( "192.168.0.1", 0 ) } );
+      test.execute( ExpectFrame { make_frame(
+        local_eth,
+        ETHERNET_BROADCAST,
+        EthernetHeader::TYPE_ARP,
+        serialize( make_arp( ARPMessage::OPCODE_REQUEST, local_eth, "1.2.3.4", {}, "192.168.0.1" ) ) ) } );
+      test.execute( ExpectNoFrame {} );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return EXIT_FAILURE;
@@ -13,10 +13,12 @@ class NetworkInterfaceTestHarness : public TestHarness<NetworkInterface>
 public:
   NetworkInterfaceTestHarness( std::string test_name,
                                const EthernetAddress& ethernet_address,
-                               const Address& ip_address )
+                               const Address& ip_address,
+                               size_t mtu = NetworkInterface::DEFAULT_MTU )
     : TestHarness( move( test_name ),
-                   "eth=" + to_string( ethernet_address ) + ", ip=" + ip_address.ip(),
-                   NetworkInterface { ethernet_address, ip_address } )
+                   "eth=" + to_string( ethernet_address ) + ", ip=" + ip_address.ip()
+                     + ", mtu=" + std::to_string( mtu ),
+                   NetworkInterface { ethernet_address, ip_address, mtu } )
   {}
 };
 
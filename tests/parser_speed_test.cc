@@ -0,0 +1,151 @@
+#include "ethernet_frame.hh"
+#include "ipv4_datagram.hh"
+#include "parser.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// What decoding the Ethernet, IPv4 and TCP headers (with timestamps and a SACK block) of a frame costs, with
+// the frame as the serializer leaves it (one Buffer per header), in one Buffer (as read from a device), and in
+// 3-byte pieces (so most integers of more than a byte span Buffers). The frame has no payload, so it is all
+// header. Then the same for a run of 32-bit integers alone, without the allocations that decoding a frame
+// makes. Prints CSV, with the best of a few rounds (this is sensitive to noise from other processes).
+
+namespace {
+
+constexpr uint64_t FRAMES = 100'000;
+constexpr uint64_t INTEGERS = 1024;
+constexpr int ROUNDS = 5;
+
+volatile uint32_t sink; // keeps the integers from being optimized away
+
+void report( const string& what, const string& layout, size_t buffers, double ns )
+{
+  cout << what << "," << layout << "," << buffers << "," << fixed << setprecision( 1 ) << ns << "\n";
+}
+
+vector<Buffer> make_frame()
+{
+  TCPSegment seg;
+  seg.udinfo.src_port = 1234;
+  seg.udinfo.dst_port = 80;
+  seg.sender_message.seqno = Wrap32 { 1000 };
+  seg.sender_message.timestamp = 12345;
+  seg.receiver_message.ackno = Wrap32 { 2000 };
+  seg.receiver_message.window_size = 5000;
+  seg.receiver_message.timestamp_echo = 54321;
+  seg.receiver_message.sack = { { Wrap32 { 3000 }, Wrap32 { 4000 } } };
+
+  InternetDatagram dgram;
+  dgram.header.src = 0x0a000001;
+  dgram.header.dst = 0x0a000002;
+  size_t segment_length = 0;
+  for ( const auto& buf : serialize( seg ) ) {
+    segment_length += buf.size();
+  }
+  dgram.header.len = static_cast<uint16_t>( IPv4Header::LENGTH + segment_length );
+  seg.compute_checksum( dgram.header.pseudo_checksum() );
+  dgram.header.compute_checksum();
+  dgram.payload = serialize( seg );
+
+  EthernetFrame frame;
+  frame.header = { { 0x02, 0, 0, 0, 0, 1 }, { 0x02, 0, 0, 0, 0, 2 }, EthernetHeader::TYPE_IPv4 };
+  frame.payload = serialize( dgram );
+  return serialize( frame );
+}
+
+vector<Buffer> split( const vector<Buffer>& frame, size_t piece )
+{
+  string all;
+  for ( const auto& buf : frame ) {
+    all.append( buf );
+  }
+  vector<Buffer> pieces;
+  for ( size_t i = 0; i < all.size(); i += piece ) {
+    pieces.emplace_back( all.substr( i, piece ) );
+  }
+  return pieces;
+}
+
+void decode_test( const string& layout, const vector<Buffer>& buffers )
+{
+  double best_ns = numeric_limits<double>::max();
+  for ( int round = 0; round < ROUNDS; ++round ) {
+    const auto start = steady_clock::now();
+    for ( uint64_t i = 0; i < FRAMES; ++i ) {
+      EthernetFrame frame;
+      InternetDatagram dgram;
+      TCPSegment seg;
+      if ( not parse( frame, buffers ) or not parse( dgram, frame.payload )
+           or not parse( seg, dgram.payload, dgram.header.pseudo_checksum() ) ) {
+        throw runtime_error( "frame failed to decode (" + layout + ")" );
+      }
+      if ( seg.receiver_message.sack.size() != 1 or seg.receiver_message.timestamp_echo != 54321 ) {
+        throw runtime_error( "frame decoded wrong (" + layout + ")" );
+      }
+    }
+    best_ns = min( best_ns, duration_cast<duration<double, nano>>( steady_clock::now() - start ).count() );
+  }
+
+  report( "frame", layout, buffers.size(), best_ns / FRAMES );
+}
+
+void integer_test( const string& layout, const vector<Buffer>& buffers )
+{
+  double best_ns = numeric_limits<double>::max();
+  uint32_t total = 0;
+  for ( int round = 0; round < ROUNDS; ++round ) {
+    const auto start = steady_clock::now();
+    for ( uint64_t i = 0; i < FRAMES / 10; ++i ) {
+      Parser parser { buffers };
+      uint32_t value {};
+      for ( uint64_t j = 0; j < INTEGERS; ++j ) {
+        parser.integer( value );
+        total += value;
+      }
+      if ( parser.has_error() ) {
+        throw runtime_error( "integers failed to decode (" + layout + ")" );
+      }
+    }
+    best_ns = min( best_ns, duration_cast<duration<double, nano>>( steady_clock::now() - start ).count() );
+  }
+  sink = total;
+
+  report( "u32", layout, buffers.size(), best_ns / ( FRAMES / 10 * INTEGERS ) );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    const auto frame = make_frame();
+    cout << "decoding,layout,buffers,ns_each\n";
+    decode_test( "serialized", frame );
+    decode_test( "contiguous", split( frame, SIZE_MAX ) );
+    decode_test( "3_byte_pieces", split( frame, 3 ) );
+
+    const vector<Buffer> integers { string( INTEGERS * sizeof( uint32_t ), '\x5a' ) };
+    integer_test( "contiguous", integers );
+    integer_test( "3_byte_pieces", split( integers, 3 ) );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
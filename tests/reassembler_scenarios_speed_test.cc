@@ -0,0 +1,379 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Named adversarial arrival patterns for the Reassembler, each run in both modes. For every run this
+// reports throughput, peak bytes_pending(), heap allocations and peak RSS, as CSV (default) or JSON:
+//
+//   reassembler_scenarios_speed_test [--json] [--trace FILE]
+//
+// A trace FILE replays captured arrivals instead of the synthetic loss pattern: one
+// "first_index length [last]" per line (the bytes themselves are generated).
+
+namespace {
+uint64_t allocation_count = 0; // operator new calls (the benchmark is single-threaded)
+} // namespace
+
+void* operator new( size_t size )
+{
+  ++allocation_count;
+  if ( void* ptr = malloc( size == 0 ? 1 : size ) ) { // NOLINT(*-no-malloc, *-owning-memory)
+    return ptr;
+  }
+  throw bad_alloc {};
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+void operator delete( void* ptr, size_t /* size */ ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+struct Segment
+{
+  uint64_t first_index;
+  string data;
+  bool is_last;
+};
+
+struct Scenario
+{
+  string name {};
+  uint64_t capacity {};
+  string data {};
+  vector<Segment> segments {};
+  size_t runs { 1 }; // each run starts from a fresh ByteStream and Reassembler
+
+  void add( uint64_t first_index, uint64_t length )
+  {
+    length = min( length, data.size() - first_index );
+    segments.push_back( { first_index, data.substr( first_index, length ), first_index + length == data.size() } );
+  }
+};
+
+struct Result
+{
+  string scenario;
+  string mode;
+  uint64_t bytes;
+  double seconds;
+  uint64_t peak_bytes_pending;
+  uint64_t allocations;
+  uint64_t peak_rss_kb;
+
+  double gigabits_per_second() const { return 8 * static_cast<double>( bytes ) / seconds / 1e9; }
+};
+
+string generate_data( const size_t len, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud;
+  string ret;
+  for ( size_t i = 0; i < len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
+
+// Peak RSS is per process, so it is reset (where the kernel allows it) before each run
+void reset_peak_rss()
+{
+  ofstream clear_refs { "/proc/self/clear_refs" };
+  clear_refs << "5\n";
+}
+
+uint64_t peak_rss_kb()
+{
+  ifstream status { "/proc/self/status" };
+  string line;
+  while ( getline( status, line ) ) {
+    if ( line.starts_with( "VmHWM:" ) ) {
+      return stoull( line.substr( line.find_first_of( "0123456789" ) ) );
+    }
+  }
+  return 0;
+}
+
+Result measure( const Scenario& scenario, const Reassembler::Mode mode )
+{
+  Result result { scenario.name,
+                  mode == Reassembler::Mode::InPlace ? "in_place" : "buffered",
+                  scenario.data.size() * scenario.runs,
+                  0,
+                  0,
+                  0,
+                  0 };
+
+  reset_peak_rss();
+  for ( size_t run = 0; run < scenario.runs; ++run ) {
+    auto segments = scenario.segments; // copied outside the timed (and counted) region
+    string output_data;
+    output_data.resize( scenario.data.size() ); // fault the pages in now, so whichever mode runs first isn't charged
+    output_data.clear();
+    ByteStream stream { scenario.capacity };
+    Reassembler reassembler { mode };
+
+    const auto allocations_before = allocation_count;
+    const auto start_time = steady_clock::now();
+    for ( auto& segment : segments ) {
+      reassembler.insert( segment.first_index, move( segment.data ), segment.is_last, stream.writer() );
+      result.peak_bytes_pending = max( result.peak_bytes_pending, reassembler.bytes_pending() );
+
+      while ( stream.reader().bytes_buffered() ) {
+        const auto chunk = stream.reader().peek();
+        output_data += chunk;
+        stream.reader().pop( chunk.size() );
+      }
+    }
+    const auto stop_time = steady_clock::now();
+    result.allocations += allocation_count - allocations_before;
+    result.seconds += duration_cast<duration<double>>( stop_time - start_time ).count();
+
+    if ( not stream.reader().is_finished() ) {
+      throw runtime_error( scenario.name + ": Reassembler did not close ByteStream when finished" );
+    }
+    if ( output_data != scenario.data ) {
+      throw runtime_error( scenario.name + ": mismatch between data written and read" );
+    }
+  }
+  result.peak_rss_kb = peak_rss_kb();
+  return result;
+}
+
+// Each window's segments arrive last-first
+Scenario reverse_order()
+{
+  Scenario s { "reverse_order", 64000, generate_data( 16'000'000, 2001 ) };
+  const uint64_t segment_size = 1000;
+  for ( uint64_t window = 0; window < s.data.size(); window += s.capacity ) {
+    const auto window_end = min<uint64_t>( window + s.capacity, s.data.size() );
+    for ( uint64_t i = window_end; i > window; ) {
+      i -= min( segment_size, i - window );
+      s.add( i, segment_size );
+    }
+  }
+  return s;
+}
+
+// Each window first arrives with a 1-byte hole after every 15 bytes, then the holes are filled one by one
+Scenario one_byte_holes()
+{
+  Scenario s { "one_byte_holes", 64000, generate_data( 2'000'000, 2002 ) };
+  const uint64_t stride = 16;
+  for ( uint64_t window = 0; window < s.data.size(); window += s.capacity ) {
+    const auto window_end = min<uint64_t>( window + s.capacity, s.data.size() );
+    for ( uint64_t i = window; i < window_end; i += stride ) {
+      s.add( i + 1, min( stride, window_end - i ) - 1 );
+    }
+    for ( uint64_t i = window; i < window_end; i += stride ) {
+      s.add( i, 1 );
+    }
+  }
+  return s;
+}
+
+// Segments start every 250 bytes but are 1000 bytes long, shuffled within the window, each sent twice
+Scenario overlap_duplicates()
+{
+  Scenario s { "overlap_duplicates", 64000, generate_data( 8'000'000, 2003 ) };
+  default_random_engine rd { 2003 };
+  vector<uint64_t> starts;
+  for ( uint64_t window = 0; window < s.data.size(); window += s.capacity ) {
+    starts.clear();
+    const auto window_end = min<uint64_t>( window + s.capacity, s.data.size() );
+    for ( uint64_t i = window; i < window_end; i += 250 ) {
+      starts.push_back( i );
+      starts.push_back( i );
+    }
+    shuffle( starts.begin(), starts.end(), rd );
+    for ( const auto i : starts ) {
+      s.add( i, min<uint64_t>( 1000, window_end - i ) );
+    }
+  }
+  return s;
+}
+
+// Every segment is twice the capacity and lands just ahead of, at, or just behind the next index,
+// so most of each one is truncated at the window edge
+Scenario window_edge_truncation()
+{
+  Scenario s { "window_edge_truncation", 1500, generate_data( 15'000'000, 2004 ) };
+  for ( uint64_t i = 0; i < s.data.size(); i += s.capacity ) {
+    s.add( i + 2, s.capacity * 2 );
+    s.add( i, s.capacity * 2 );
+    s.add( i + 1, s.capacity * 2 );
+  }
+  return s;
+}
+
+// A stream that fits in the window, whose last substring arrives first and the rest shuffled
+Scenario last_substring_first()
+{
+  Scenario s { "last_substring_first", 1'000'000, generate_data( 1'000'000, 2005 ) };
+  s.runs = 10;
+  const uint64_t segment_size = 1460;
+  vector<uint64_t> starts;
+  for ( uint64_t i = 0; i < s.data.size(); i += segment_size ) {
+    starts.push_back( i );
+  }
+  s.add( starts.back(), segment_size );
+  starts.pop_back();
+  shuffle( starts.begin(), starts.end(), default_random_engine { 2005 } );
+  for ( const auto i : starts ) {
+    s.add( i, segment_size );
+  }
+  return s;
+}
+
+// Full-size segments in order, dropped in bursts (a two-state Gilbert-Elliott channel) and each lost
+// segment retransmitted (and delivered) 20 segments later, well within the window
+Scenario loss_pattern()
+{
+  Scenario s { "loss_pattern", 64000, generate_data( 16'000'000, 2006 ) };
+  const uint64_t mss = 1460;
+  const size_t retransmit_delay = 20;
+  default_random_engine rd { 2006 };
+  bernoulli_distribution enter_bad { 0.01 };
+  bernoulli_distribution leave_bad { 0.3 };
+  bernoulli_distribution lost_when_bad { 0.5 };
+
+  vector<vector<uint64_t>> retransmissions( s.data.size() / mss + retransmit_delay + 2 );
+  bool bad = false;
+  size_t slot = 0;
+  for ( uint64_t i = 0; i < s.data.size(); i += mss, ++slot ) {
+    bad = bad ? not leave_bad( rd ) : enter_bad( rd );
+    if ( bad and lost_when_bad( rd ) ) {
+      retransmissions.at( slot + retransmit_delay ).push_back( i );
+    } else {
+      s.add( i, mss );
+    }
+    for ( const auto lost : retransmissions.at( slot ) ) {
+      s.add( lost, mss );
+    }
+  }
+  for ( ; slot < retransmissions.size(); ++slot ) {
+    for ( const auto lost : retransmissions.at( slot ) ) {
+      s.add( lost, mss );
+    }
+  }
+  return s;
+}
+
+// Replay "first_index length [last]" lines from a captured trace
+Scenario trace_replay( const string& filename )
+{
+  ifstream trace { filename };
+  if ( not trace ) {
+    throw runtime_error( "cannot open trace " + filename );
+  }
+  vector<pair<uint64_t, uint64_t>> arrivals;
+  uint64_t stream_end = 0;
+  string line;
+  while ( getline( trace, line ) ) {
+    istringstream fields { line };
+    uint64_t first_index {};
+    uint64_t length {};
+    if ( fields >> first_index >> length ) {
+      arrivals.emplace_back( first_index, length );
+      stream_end = max( stream_end, first_index + length );
+    }
+  }
+
+  Scenario s { "trace:" + filename, 64000, generate_data( stream_end, 2007 ) };
+  for ( const auto& [first_index, length] : arrivals ) {
+    s.add( first_index, length );
+  }
+  return s;
+}
+
+void print_csv( const vector<Result>& results )
+{
+  cout << "scenario,mode,bytes,seconds,gbit_per_s,peak_bytes_pending,allocations,peak_rss_kb\n";
+  for ( const auto& r : results ) {
+    cout << r.scenario << "," << r.mode << "," << r.bytes << "," << fixed << setprecision( 6 ) << r.seconds << ","
+         << setprecision( 3 ) << r.gigabits_per_second() << "," << r.peak_bytes_pending << "," << r.allocations
+         << "," << r.peak_rss_kb << "\n";
+  }
+}
+
+void print_json( const vector<Result>& results )
+{
+  cout << "[\n";
+  for ( size_t i = 0; i < results.size(); ++i ) {
+    const auto& r = results[i];
+    cout << "  {\"scenario\": \"" << r.scenario << "\", \"mode\": \"" << r.mode << "\", \"bytes\": " << r.bytes
+         << ", \"seconds\": " << fixed << setprecision( 6 ) << r.seconds
+         << ", \"gbit_per_s\": " << setprecision( 3 ) << r.gigabits_per_second()
+         << ", \"peak_bytes_pending\": " << r.peak_bytes_pending << ", \"allocations\": " << r.allocations
+         << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+  }
+  cout << "]\n";
+}
+
+void program_body( span<char*> args )
+{
+  bool json = false;
+  string trace;
+  for ( size_t i = 1; i < args.size(); ++i ) {
+    const string_view arg { args[i] };
+    if ( arg == "--json" ) {
+      json = true;
+    } else if ( arg == "--trace" and i + 1 < args.size() ) {
+      trace = args[++i];
+    } else {
+      throw runtime_error( "usage: " + string { args[0] } + " [--json] [--trace FILE]" );
+    }
+  }
+
+  vector<Scenario> scenarios;
+  scenarios.push_back( reverse_order() );
+  scenarios.push_back( one_byte_holes() );
+  scenarios.push_back( overlap_duplicates() );
+  scenarios.push_back( window_edge_truncation() );
+  scenarios.push_back( last_substring_first() );
+  scenarios.push_back( trace.empty() ? loss_pattern() : trace_replay( trace ) );
+
+  vector<Result> results;
+  for ( const auto& scenario : scenarios ) {
+    for ( const auto mode : { Reassembler::Mode::InPlace, Reassembler::Mode::Buffered } ) {
+      results.push_back( measure( scenario, mode ) );
+    }
+  }
+
+  if ( json ) {
+    print_json( results );
+  } else {
+    print_csv( results );
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  try {
+    program_body( { argv, static_cast<size_t>( argc ) } );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -9,35 +9,34 @@
 #include <queue>
 #include <random>
 #include <tuple>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
 
-void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
-{
-  // Generate the data to be written
-  const string data = [&] {
-    default_random_engine rd { random_seed };
-    uniform_int_distribution<char> ud;
-    string ret;
-    for ( size_t i = 0; i < num_chunks * capacity; ++i ) {
-      ret += ud( rd );
-    }
-    return ret;
-  }();
+using Segments = queue<tuple<uint64_t, string, bool>>;
 
-  // Split the data into segments before writing
-  queue<tuple<uint64_t, string, bool>> split_data;
-  for ( size_t i = 0; i < data.size(); i += capacity ) {
-    split_data.emplace( i + 2, data.substr( i + 2, capacity * 2 ), i + 2 + capacity * 2 >= data.size() );
-    split_data.emplace( i, data.substr( i, capacity * 2 ), i + capacity * 2 >= data.size() );
-    split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
+string generate_data( const size_t len, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<char> ud;
+  string ret;
+  for ( size_t i = 0; i < len; ++i ) {
+    ret += ud( rd );
   }
+  return ret;
+}
 
+// Insert every segment in order (draining the stream after each) and report the throughput
+void measure( string description,
+              const string& data,
+              Segments split_data,
+              const size_t capacity,
+              const Reassembler::Mode mode )
+{
   ByteStream stream { capacity };
-  Reassembler reassembler;
+  Reassembler reassembler { mode };
+  description += mode == Reassembler::Mode::InPlace ? " (in place)" : " (buffered)";
 
   string output_data;
   output_data.reserve( data.size() );
@@ -65,27 +64,80 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   }
 
   auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
-  auto bytes_per_second = static_cast<double>( num_chunks * capacity ) / test_duration.count();
+  auto bytes_per_second = static_cast<double>( data.size() ) / test_duration.count();
   auto bits_per_second = 8 * bytes_per_second;
   auto gigabits_per_second = bits_per_second / 1e9;
 
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision( 2 )
-       << gigabits_per_second << " Gbit/s.\n";
+  cout << "Reassembler to ByteStream with capacity=" << capacity << description << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
 
-  debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  debug_output << "             Reassembler throughput" << description << ": " << fixed << setprecision( 2 )
+               << gigabits_per_second << " Gbit/s\n";
 
   if ( gigabits_per_second < 0.1 ) {
     throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
   }
 }
 
+void speed_test( const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                 const Reassembler::Mode mode )
+{
+  // Generate the data to be written
+  const string data = generate_data( num_chunks * capacity, random_seed );
+
+  // Split the data into segments before writing
+  Segments split_data;
+  for ( size_t i = 0; i < data.size(); i += capacity ) {
+    split_data.emplace( i + 2, data.substr( i + 2, capacity * 2 ), i + 2 + capacity * 2 >= data.size() );
+    split_data.emplace( i, data.substr( i, capacity * 2 ), i + capacity * 2 >= data.size() );
+    split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
+  }
+
+  measure( "", data, move( split_data ), capacity, mode );
+}
+
+// Every window's worth of segments arrives in a random order, so most inserts land out of order
+void reorder_speed_test( const size_t num_windows,  // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t segment_size, // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t random_seed,  // NOLINT(bugprone-easily-swappable-parameters)
+                         const Reassembler::Mode mode )
+{
+  const string data = generate_data( num_windows * capacity, random_seed );
+  default_random_engine rd { random_seed };
+
+  Segments split_data;
+  vector<uint64_t> window;
+  for ( size_t i = 0; i < data.size(); i += capacity ) {
+    window.clear();
+    for ( size_t j = i; j < min( i + capacity, data.size() ); j += segment_size ) {
+      window.push_back( j );
+    }
+    shuffle( window.begin(), window.end(), rd );
+    for ( const auto j : window ) {
+      split_data.emplace( j, data.substr( j, segment_size ), j + segment_size >= data.size() );
+    }
+  }
+
+  measure( ", segment_size=" + to_string( segment_size ) + ", shuffled per window",
+           data,
+           move( split_data ),
+           capacity,
+           mode );
+}
+
 void program_body()
 {
-  speed_test( 10000, 1500, 1370 );
+  for ( const auto mode : { Reassembler::Mode::InPlace, Reassembler::Mode::Buffered } ) {
+    speed_test( 10000, 1500, 1370, mode );
+    reorder_speed_test( 200, 64000, 1000, 1371, mode );
+    reorder_speed_test( 50, 64000, 100, 1372, mode );
+  }
 }
 
 int main()
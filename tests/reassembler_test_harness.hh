@@ -10,6 +10,11 @@
 
 using StreamAndReassembler = std::pair<ByteStream, Reassembler>;
 
+// The reassembler_* tests are also built with REASSEMBLER_TEST_MODE=Buffered (see tests/CMakeLists.txt)
+#ifndef REASSEMBLER_TEST_MODE
+#define REASSEMBLER_TEST_MODE InPlace
+#endif
+
 template<std::derived_from<TestStep<ByteStream>> T>
 struct ReassemblerByteStreamTestStep : public TestStep<StreamAndReassembler>
 {
@@ -28,10 +33,12 @@ struct ReassemblerByteStreamTestStep : public TestStep<StreamAndReassembler>
 class ReassemblerTestHarness : public TestHarness<StreamAndReassembler>
 {
 public:
+  static constexpr Reassembler::Mode mode = Reassembler::Mode::REASSEMBLER_TEST_MODE;
+
   ReassemblerTestHarness( std::string test_name, uint64_t capacity )
     : TestHarness( move( test_name ),
                    "capacity=" + std::to_string( capacity ),
-                   { ByteStream { capacity }, Reassembler {} } )
+                   { ByteStream { capacity }, Reassembler { mode } } )
   {}
 
   template<std::derived_from<TestStep<ByteStream>> T>
@@ -5,9 +5,11 @@
 #include "tcp_receiver.hh"
 #include "tcp_receiver_message.hh"
 
+#include <algorithm>
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using ReceiverSet = std::pair<StreamAndReassembler, TCPReceiver>;
 
@@ -66,6 +68,39 @@ struct ExpectAckno : public ExpectNumber<ReceiverSet, std::optional<Wrap32>>
   }
 };
 
+// SACK blocks from send( writer, reassembler ), given as [left, right) sequence numbers
+struct ExpectSackBlocks : public Expectation<ReceiverSet>
+{
+  std::vector<SackBlock> blocks_;
+
+  explicit ExpectSackBlocks( std::vector<SackBlock> blocks ) : blocks_( std::move( blocks ) ) {}
+
+  static std::string to_string( const std::vector<SackBlock>& blocks )
+  {
+    std::ostringstream ss;
+    ss << "{";
+    for ( const auto& block : blocks ) {
+      ss << " [" << block.left << ", " << block.right << ")";
+    }
+    ss << " }";
+    return ss.str();
+  }
+
+  std::string description() const override { return "SACK blocks = " + to_string( blocks_ ); }
+
+  void execute( ReceiverSet& rs ) const override
+  {
+    const auto sack = rs.second.send( rs.first.first.writer(), rs.first.second ).sack;
+    const bool same = std::equal( sack.begin(), sack.end(), blocks_.begin(), blocks_.end(), []( auto a, auto b ) {
+      return a.left == b.left and a.right == b.right;
+    } );
+    if ( not same ) {
+      throw ExpectationViolation( "The TCPReceiver should have sent SACK blocks " + to_string( blocks_ )
+                                  + ", but instead sent " + to_string( sack ) + "." );
+    }
+  }
+};
+
 struct ExpectAcknoBetween : public Expectation<ReceiverSet>
 {
   Wrap32 isn_;
@@ -94,6 +129,16 @@ struct ExpectAcknoBetween : public Expectation<ReceiverSet>
   }
 };
 
+struct ExpectTimestampEcho : public ExpectNumber<ReceiverSet, std::optional<uint32_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "timestamp_echo"; }
+  std::optional<uint32_t> value( ReceiverSet& rs ) const override
+  {
+    return rs.second.send( rs.first.first.writer() ).timestamp_echo;
+  }
+};
+
 struct HasAckno : public ExpectBool<ReceiverSet>
 {
   using ExpectBool::ExpectBool;
@@ -135,6 +180,12 @@ struct SegmentArrives : public Action<ReceiverSet>
     return *this;
   }
 
+  SegmentArrives& with_timestamp( uint32_t tsval )
+  {
+    msg_.timestamp = tsval;
+    return *this;
+  }
+
   SegmentArrives& without_ackno()
   {
     ackno_expected_ = HasAckno { false };
@@ -161,6 +212,9 @@ struct SegmentArrives : public Action<ReceiverSet>
     if ( msg_.FIN ) {
       ss << " +FIN";
     }
+    if ( msg_.timestamp.has_value() ) {
+      ss << " tsval=" << msg_.timestamp.value();
+    }
     ss << ")";
 
     if ( ackno_expected_.value_ ) {
@@ -171,3 +225,12 @@ struct SegmentArrives : public Action<ReceiverSet>
     return ss.str();
   }
 };
+
+struct SetWindowScale : public Action<ReceiverSet>
+{
+  uint8_t shift_;
+
+  explicit SetWindowScale( uint8_t shift ) : shift_( shift ) {}
+  std::string description() const override { return "window scale set to " + std::to_string( shift_ ); }
+  void execute( ReceiverSet& rs ) const override { rs.second.set_window_scale( shift_ ); }
+};
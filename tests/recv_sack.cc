@@ -0,0 +1,104 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks follow the out-of-order data", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectSackBlocks { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 6 ).with_data( "fgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 6 }, Wrap32 { isn + 9 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( "klm" ) );
+      test.execute(
+        ExpectSackBlocks { { { Wrap32 { isn + 6 }, Wrap32 { isn + 9 } }, { Wrap32 { isn + 11 }, Wrap32 { isn + 14 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ij" ) );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 6 }, Wrap32 { isn + 14 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcde" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 14 } } );
+      test.execute( ExpectSackBlocks { {} } );
+      test.execute( ReadAll { "abcdefghijklm" } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "At most MAX_SACK_BLOCKS blocks, lowest first", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      vector<SackBlock> expected;
+      for ( uint32_t i = 0; i < 6; ++i ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 3 + 3 * i ).with_data( "x" ) );
+        if ( expected.size() < TCPReceiverMessage::MAX_SACK_BLOCKS ) {
+          expected.push_back( { Wrap32 { isn + 3 + 3 * i }, Wrap32 { isn + 4 + 3 * i } } );
+        }
+      }
+      test.execute( ExpectSackBlocks { expected } );
+    }
+
+    // the Buffered Reassembler reports the same ranges
+    {
+      ByteStream stream { 100 };
+      Reassembler reassembler { Reassembler::Mode::Buffered };
+      reassembler.insert( 5, "fgh", false, stream.writer() );
+      reassembler.insert( 8, "ij", false, stream.writer() );
+      reassembler.insert( 20, "uv", false, stream.writer() );
+      const auto ranges = reassembler.pending_ranges( 4 );
+      if ( ranges != vector<pair<uint64_t, uint64_t>> { { 5, 10 }, { 20, 22 } } ) {
+        throw runtime_error( "Buffered Reassembler::pending_ranges() returned the wrong ranges" );
+      }
+    }
+
+    // SACK-permitted and SACK blocks survive TCPSegment serialize/parse
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPSegment seg;
+      seg.sender_message.seqno = Wrap32 { isn };
+      seg.sender_message.SYN = true;
+      seg.sender_message.payload = string { "hello" };
+      seg.receiver_message.ackno = Wrap32 { isn + 7 };
+      seg.receiver_message.window_size = 1000;
+      seg.sack_permitted = true;
+      for ( uint32_t i = 0; i < TCPReceiverMessage::MAX_SACK_BLOCKS + 1; ++i ) {
+        seg.receiver_message.sack.push_back( { Wrap32 { isn + 100 * i }, Wrap32 { isn + 100 * i + 50 } } );
+      }
+      seg.compute_checksum( 0 );
+
+      TCPSegment parsed;
+      if ( not parse( parsed, serialize( seg ), 0 ) ) {
+        throw runtime_error( "TCPSegment with SACK options failed to parse" );
+      }
+      if ( not parsed.sack_permitted or static_cast<string>( parsed.sender_message.payload ) != "hello" ) {
+        throw runtime_error( "TCPSegment lost the SACK-permitted option or the payload" );
+      }
+      // SACK-permitted (2 bytes) leaves room for 4 blocks of 8 bytes in 40 bytes of options
+      if ( parsed.receiver_message.sack.size() != 4 ) {
+        throw runtime_error( "TCPSegment serialized " + to_string( parsed.receiver_message.sack.size() )
+                             + " SACK blocks, expected 4" );
+      }
+      for ( size_t i = 0; i < parsed.receiver_message.sack.size(); ++i ) {
+        if ( not( parsed.receiver_message.sack[i].left == seg.receiver_message.sack[i].left )
+             or not( parsed.receiver_message.sack[i].right == seg.receiver_message.sack[i].right ) ) {
+          throw runtime_error( "TCPSegment SACK block " + to_string( i ) + " changed in serialize/parse" );
+        }
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "no timestamps, no echo", cap };
+      test.execute( ExpectTimestampEcho { nullopt } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectTimestampEcho { nullopt } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectTimestampEcho { nullopt } );
+    }
+
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "echo the timestamp of the latest in-order segment", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_timestamp( 1000 ) );
+      test.execute( ExpectTimestampEcho { 1000 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ).with_timestamp( 1010 ) );
+      test.execute( ExpectTimestampEcho { 1010 } );
+
+      // out of order: keep echoing the segment that the ACK is really for
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ijkl" ).with_timestamp( 1030 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ExpectTimestampEcho { 1010 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ).with_timestamp( 1040 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 13 } } );
+      test.execute( ExpectTimestampEcho { 1040 } );
+    }
+
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "PAWS rejects a segment with an old timestamp", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_timestamp( 500 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ).with_timestamp( 600 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+
+      // an old duplicate whose seqno happens to land in the window
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "XXXX" ).with_timestamp( 550 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ExpectTimestampEcho { 600 } );
+      test.execute( BytesPushed { 4 } );
+
+      // the same timestamp is fine (several segments per clock tick)
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ).with_timestamp( 600 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 9 } } );
+      test.execute( ReadAll { "abcdefgh" } );
+    }
+
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "timestamps compare across 32-bit wraparound", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_timestamp( UINT32_MAX - 10 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ).with_timestamp( 5 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ExpectTimestampEcho { 5 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "XXXX" ).with_timestamp( UINT32_MAX ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include "receiver_test_harness.hh"
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// The SYN options survive serialize/parse, with an oversized window scale clamped to 14
+static void check_option_roundtrip( optional<uint8_t> shift, optional<uint8_t> expected )
+{
+  TCPSegment seg;
+  seg.sender_message.SYN = true;
+  seg.sack_permitted = true;
+  seg.window_scale = shift;
+  seg.mss = 1460;
+  seg.compute_checksum( 0 );
+
+  Serializer serializer;
+  seg.serialize( serializer );
+  string bytes;
+  for ( const auto& buf : serializer.output() ) {
+    bytes.append( buf );
+  }
+
+  TCPSegment parsed;
+  Parser parser { vector<Buffer> { Buffer { bytes } } };
+  parsed.parse( parser, 0 );
+  if ( parser.has_error() ) {
+    throw runtime_error( "could not parse a segment with the window scale option" );
+  }
+  if ( parsed.window_scale != expected or not parsed.sack_permitted or parsed.mss != 1460 ) {
+    throw runtime_error( "window scale option did not survive serialize/parse" );
+  }
+}
+
+int main()
+{
+  try {
+    check_option_roundtrip( {}, {} );
+    check_option_roundtrip( 0, 0 );
+    check_option_roundtrip( 7, 7 );
+    check_option_roundtrip( 200, TCPConfig::MAX_WINDOW_SCALE );
+
+    {
+      TCPConfig cfg;
+      cfg.recv_capacity = 1 << 20;
+      if ( cfg.window_scale() != 5 ) {
+        throw runtime_error( "1 MiB receive capacity should offer a window scale of 5" );
+      }
+      cfg.recv_capacity = UINT16_MAX;
+      if ( cfg.window_scale() != 0 ) {
+        throw runtime_error( "64 KiB receive capacity should not need window scaling" );
+      }
+    }
+
+    {
+      const size_t cap = 1 << 20;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "unscaled window is capped at 65535", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const size_t cap = 1 << 20;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "scaled window advertises the whole capacity", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SetWindowScale { 5 } );
+      test.execute( ExpectWindow { cap >> 5 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 100, 'x' ) ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 101 } } );
+      test.execute( ExpectWindow { ( cap - 100 ) >> 5 } ); // rounds down
+      test.execute( ReadAll { string( 100, 'x' ) } );
+      test.execute( ExpectWindow { cap >> 5 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,5 +1,6 @@
 #include "router.hh"
 #include "arp_message.hh"
+#include "checksum.hh"
 #include "network_interface_test_harness.hh"
 #include "random.hh"
 
@@ -240,6 +241,42 @@ public:
   }
 };
 
+// Patching the checksum for a changed word gives the same bits as computing it again
+void incremental_checksum_test()
+{
+  auto rd = get_random_engine();
+  uniform_int_distribution<uint32_t> dist { 0, UINT32_MAX };
+  for ( int i = 0; i < 100000; ++i ) {
+    IPv4Header header;
+    header.tos = static_cast<uint8_t>( dist( rd ) );
+    header.len = static_cast<uint16_t>( dist( rd ) );
+    header.id = static_cast<uint16_t>( dist( rd ) );
+    header.df = dist( rd ) % 2;
+    header.ttl = static_cast<uint8_t>( dist( rd ) % 255 + 1 );
+    header.proto = static_cast<uint8_t>( dist( rd ) );
+    header.src = dist( rd );
+    header.dst = dist( rd );
+    header.compute_checksum();
+
+    IPv4Header expected = header;
+    expected.ttl--;
+    expected.compute_checksum();
+    header.decrement_ttl();
+    if ( header.cksum != expected.cksum ) {
+      throw runtime_error( "decrement_ttl() checksum differs from compute_checksum() for " + header.to_string() );
+    }
+
+    // the same for any other word, e.g. the low half of the source address (as NAT rewrites it)
+    const uint16_t port = static_cast<uint16_t>( dist( rd ) );
+    const uint16_t patched = InternetChecksum::update( header.cksum, static_cast<uint16_t>( header.src ), port );
+    header.src = ( header.src & 0xffff0000 ) | port;
+    header.compute_checksum();
+    if ( patched != header.cksum ) {
+      throw runtime_error( "InternetChecksum::update() differs from compute_checksum() for " + header.to_string() );
+    }
+  }
+}
+
 void network_simulator()
 {
   const string green = "\033[32;1m";
@@ -329,6 +366,7 @@ void network_simulator()
 int main()
 {
   try {
+    incremental_checksum_test();
     network_simulator();
   } catch ( const exception& e ) {
     cerr << "\n\n\n";
@@ -0,0 +1,127 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+    const uint16_t big_window = 60000;
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without congestion control only the receiver's window limits", cfg };
+      test.execute( ExpectCongestionWindow { UINT64_MAX } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( big_window ) );
+      test.execute( Push { string( 20 * mss, 'a' ) } );
+      test.execute( ExpectSeqnosInFlight { 20 * mss } );
+    }
+
+    for ( const auto algorithm : { TCPConfig::CongestionControl::Reno,
+                                   TCPConfig::CongestionControl::NewReno,
+                                   TCPConfig::CongestionControl::Cubic } ) {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = algorithm;
+
+      TCPSenderTestHarness test { "Initial window and slow start (algorithm " + to_string( int( algorithm ) ) + ")",
+                                  cfg };
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( big_window ) );
+      test.execute( ExpectCongestionWindow { 10 * mss } ); // acking the SYN doesn't grow the window
+      test.execute( Push { string( 20 * mss, 'a' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 10 * mss } );
+
+      // each ACK of a full segment in slow start opens the window by one MSS, so two segments go out
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss } }.with_win( big_window ) );
+      test.execute( ExpectCongestionWindow { 11 * mss } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + 10 * mss ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + 11 * mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 11 * mss } );
+    }
+
+    for ( const auto algorithm : { TCPConfig::CongestionControl::Reno, TCPConfig::CongestionControl::NewReno } ) {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = algorithm;
+
+      TCPSenderTestHarness test { "Timeout collapses the window (algorithm " + to_string( int( algorithm ) ) + ")",
+                                  cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( big_window ) );
+      test.execute( Push { string( 20 * mss, 'a' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( Tick { cfg.rt_timeout - 1U } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectCongestionWindow { mss } );
+      test.execute( ExpectSlowStartThreshold { 5 * mss } ); // half of the 10 segments in flight
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // slow start again up to ssthresh...
+      for ( uint64_t acked = 1; acked <= 4; ++acked ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 + acked * mss } }.with_win( big_window ) );
+        test.execute( ExpectCongestionWindow { ( 1 + acked ) * mss } );
+      }
+      // ...then congestion avoidance: one MSS per window's worth of ACKs
+      test.execute( AckReceived { Wrap32 { isn + 1 + 5 * mss } }.with_win( big_window ) );
+      test.execute( ExpectCongestionWindow { 5 * mss } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 8 * mss } }.with_win( big_window ) );
+      test.execute( ExpectCongestionWindow { 5 * mss } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 9 * mss } }.with_win( big_window ) );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::Cubic;
+
+      TCPSenderTestHarness test { "CUBIC reduces the window by beta = 0.7", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( big_window ) );
+      test.execute( Push { string( 20 * mss, 'a' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectCongestionWindow { mss } );
+      test.execute( ExpectSlowStartThreshold { 7 * mss } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+    const uint16_t win = 60000;
+
+    // five full segments in flight, after the SYN is acked
+    const auto five_segments = [&]( TCPSenderTestHarness& test, Wrap32 isn ) {
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      test.execute( Push { string( 5 * mss, 'x' ) } );
+      for ( unsigned i = 0; i < 5; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + i * mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    };
+
+    for ( const auto algorithm : { TCPConfig::CongestionControl::Reno, TCPConfig::CongestionControl::NewReno } ) {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = algorithm;
+
+      TCPSenderTestHarness test {
+        "Third duplicate ACK retransmits without a timeout (algorithm " + to_string( int( algorithm ) ) + ")", cfg };
+      five_segments( test, isn );
+
+      // the first segment is lost; each later one draws a duplicate ACK
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // ssthresh is half the flight, and the window is inflated by the three segments that left
+      test.execute( ExpectSlowStartThreshold { 5 * mss / 2 } );
+      test.execute( ExpectCongestionWindow { 5 * mss / 2 + 3 * mss } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      test.execute( ExpectCongestionWindow { 5 * mss / 2 + 4 * mss } );
+
+      // the retransmission fills the hole: recovery ends with the window at ssthresh
+      test.execute( AckReceived { Wrap32 { isn + 1 + 5 * mss } }.with_win( win ) );
+      test.execute( ExpectCongestionWindow { 5 * mss / 2 } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno retransmits the next hole on a partial ACK", cfg };
+      five_segments( test, isn );
+
+      // the first and third segments are lost
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      }
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 2 * mss } }.with_win( win ).without_push() );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + 2 * mss ) );
+      test.execute( ExpectNoSegment {} );
+      // deflated by the 2 MSS acked, plus one MSS back
+      test.execute( ExpectCongestionWindow { 5 * mss / 2 + 3 * mss - 2 * mss + mss } );
+
+      test.execute( AckReceived { Wrap32 { isn + 1 + 5 * mss } }.with_win( win ) );
+      test.execute( ExpectCongestionWindow { 5 * mss / 2 } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+
+      TCPSenderTestHarness test { "Reno leaves recovery on a partial ACK, so the next hole waits", cfg };
+      five_segments( test, isn );
+      for ( unsigned i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      }
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 2 * mss } }.with_win( win ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { 5 * mss / 2 } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ).with_seqno( isn + 1 + 2 * mss ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without congestion control, duplicate ACKs are only ACKs", cfg };
+      five_segments( test, isn );
+      for ( unsigned i = 0; i < 5; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( win ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+
+      TCPSenderTestHarness test { "Segments use the MSS, lowered by the peer's", cfg };
+      test.execute( ExpectSegmentSize { 1460 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 5000 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1461 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 80 ).with_seqno( isn + 2921 ) );
+      test.execute( SetMss { 1200 } );
+      test.execute( Push { string( 2000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1200 ).with_seqno( isn + 3001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 800 ).with_seqno( isn + 4201 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 2960;
+      cfg.mtu_probing = true;
+
+      TCPSenderTestHarness test { "An acknowledged probe raises the segment size", cfg };
+      test.execute( ExpectSegmentSize { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+
+      // the first probe tries the whole MSS
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2960 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2961 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 3961 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 40 ).with_seqno( isn + 4961 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 5001 } }.with_win( 20000 ) );
+      test.execute( ExpectSegmentSize { 2960 } );
+
+      // nothing left to search
+      test.execute( Push { string( 6000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2960 ).with_seqno( isn + 5001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 2960 ).with_seqno( isn + 7961 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 80 ).with_seqno( isn + 10921 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 2960;
+      cfg.mtu_probing = true;
+
+      TCPSenderTestHarness test { "A lost probe is resent in smaller segments, without backoff", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2960 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2961 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 3961 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 40 ).with_seqno( isn + 4961 ) );
+
+      test.execute( Tick { TCPConfig::TIMEOUT_DFLT } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 960 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectRetransmissionTimeout { TCPConfig::TIMEOUT_DFLT } );
+      test.execute( AckReceived { Wrap32 { isn + 5001 } }.with_win( 20000 ) );
+      test.execute( ExpectSegmentSize { TCPConfig::MAX_PAYLOAD_SIZE } );
+
+      // the next probe is halfway between what worked and what didn't
+      test.execute( Push { string( 3000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1980 ).with_seqno( isn + 5001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 6981 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 20 ).with_seqno( isn + 7981 ) );
+      test.execute( AckReceived { Wrap32 { isn + 8001 } }.with_win( 20000 ) );
+      test.execute( ExpectSegmentSize { 1980 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 2960;
+      cfg.mtu_probing = true;
+
+      TCPSenderTestHarness test { "Repeated timeouts fall back to the base segment size", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+      test.execute( Push { string( 2960, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2960 ).with_seqno( isn + 1 ) );
+      test.execute( AckReceived { Wrap32 { isn + 2961 } }.with_win( 20000 ) );
+      test.execute( ExpectSegmentSize { 2960 } );
+
+      // the path stops carrying 2960-byte segments
+      test.execute( Push { string( 2960, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 2960 ).with_seqno( isn + 2961 ) );
+      test.execute( Tick { TCPConfig::TIMEOUT_DFLT } );
+      test.execute( ExpectMessage {}.with_payload_size( 2960 ).with_seqno( isn + 2961 ) );
+      test.execute( Tick { 2 * TCPConfig::TIMEOUT_DFLT } );
+      test.execute( ExpectSegmentSize { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2961 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 3961 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 960 ).with_seqno( isn + 4961 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 8960;
+      cfg.mtu_probing = true;
+      cfg.pacing = true;
+      cfg.pacing_rate = 1'000'000; // 1000 bytes per ms
+
+      TCPSenderTestHarness test { "The pacer can afford a probe bigger than two segments", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 8960 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 8961 ) );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 40 ).with_seqno( isn + 9961 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+      cfg.pacing_rate = 100 * mss; // one segment per 10 ms
+
+      TCPSenderTestHarness test { "A configured pacing rate releases one segment per 10 ms", cfg };
+      test.execute( ExpectPacingRate { 100 * mss } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+
+      // the bucket starts with two segments' worth, less the SYN
+      test.execute( Push { string( 5 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { mss } ); // the rest waits for the pacer, not in flight yet
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 9 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + 2 * mss ) );
+      test.execute( ExpectNoSegment {} );
+
+      // a long tick releases everything it paid for
+      test.execute( Tick { 20 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + 3 * mss ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + 4 * mss ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+      cfg.pacing_rate = mss / 2; // one segment per 2 s, slower than the RTO
+      cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+
+      TCPSenderTestHarness test { "Segments waiting for the pacer don't time out", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 6 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 + mss } }.with_win( 60000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+
+      // nothing is on the wire, so the RTO has nothing to time out
+      test.execute( Tick { 1000 }.with_max_retx_exceeded( false ) );
+      test.execute( ExpectRetransmissionTimeout { 1000 } );
+      test.execute( ExpectCongestionWindow { 11 * mss } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + mss ) );
+      test.execute( ExpectNoSegment {} ); // and the first one is not sent again
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = 10000;
+      cfg.pacing = true;
+      cfg.pacing_rate = mss / 2;
+      cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+
+      TCPSenderTestHarness test { "A fast retransmission goes ahead of paced new data", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 6 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + mss ) );
+      test.execute( ExpectSeqnosInFlight { 2 * mss } );
+
+      for ( unsigned i = 0; i < TCPConfig::DUP_ACK_THRESHOLD; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      }
+      test.execute( Tick { 2000 } ); // the pacer affords one segment: the retransmission, not new data
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+      cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+
+      TCPSenderTestHarness test { "Without a configured rate, pacing follows cwnd / SRTT", cfg };
+      test.execute( ExpectPacingRate { 0 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+
+      // slow start paces at twice a window per RTT: 2 * 10 segments per 100 ms
+      test.execute( ExpectCongestionWindow { 10 * mss } );
+      test.execute( ExpectPacingRate { 2 * 10 * mss * 1000 / 100 } );
+      // the SYN went out unpaced, so the bucket is still full
+      test.execute( Push { string( 5 * mss, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 5 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + 2 * mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 10 } );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + 3 * mss ) );
+      test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + 4 * mss ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+
+      TCPSenderTestHarness test { "Without pacing, a window goes out at once", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( ExpectPacingRate { 0 } );
+      test.execute( Push { string( 4 * mss, 'x' ) } );
+      for ( unsigned i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( mss ).with_seqno( isn + 1 + i * mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
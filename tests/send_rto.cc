@@ -0,0 +1,169 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.rto_min = 1;
+
+      TCPSenderTestHarness test { "RTO follows the measured RTT, and Karn's rule skips retransmissions", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectRetransmissionTimeout { cfg.rt_timeout } );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+
+      // first sample: SRTT = 100, RTTVAR = 50, RTO = SRTT + 4 * RTTVAR
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( ExpectRetransmissionTimeout { 300 } );
+      test.execute( Push { "abcd" } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 299 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectRetransmissionTimeout { 600 } );
+
+      // the ACK of a retransmitted segment is ambiguous: no sample, but the backoff is cleared
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 5 } } );
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( ExpectRetransmissionTimeout { 300 } );
+
+      // second sample: RTTVAR = 3/4 * 50 + 1/4 * 80, SRTT = 7/8 * 100 + 1/8 * 20
+      test.execute( Push { "efgh" } );
+      test.execute( ExpectMessage {}.with_data( "efgh" ).with_seqno( isn + 5 ) );
+      test.execute( Tick { 20 } );
+      test.execute( AckReceived { Wrap32 { isn + 9 } } );
+      test.execute( ExpectSmoothedRTT { 90 } );
+      test.execute( ExpectRetransmissionTimeout { 320 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.rto_min = 200;
+
+      TCPSenderTestHarness test { "Short RTTs are clamped to rto_min", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 2 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSmoothedRTT { 2 } );
+      test.execute( ExpectRetransmissionTimeout { 200 } );
+      test.execute( Push { "abcd" } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ) );
+      test.execute( Tick { 199 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.rt_timeout = 400;
+      cfg.rto_max = 1000;
+
+      TCPSenderTestHarness test { "Backoff stops at rto_max", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 400 } );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectRetransmissionTimeout { 800 } );
+      test.execute( Tick { 800 } );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectRetransmissionTimeout { 1000 } );
+      test.execute( Tick { 999 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( ExpectRetransmissionTimeout { 1000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Without adaptive_rto, the RTT is measured but the RTO stays fixed", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( ExpectRetransmissionTimeout { cfg.rt_timeout } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rto = true;
+      cfg.rto_min = 1;
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "With timestamps, every ACK of new data is an RTT sample", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_timestamp_echo( 0 ) );
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( ExpectRetransmissionTimeout { 300 } );
+
+      // the echo tells which transmission was acknowledged, so a retransmission is sampled too
+      test.execute( Push { "abcd" } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ).with_timestamp( 100 ) );
+      test.execute( Tick { 300 } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ).with_timestamp( 400 ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 5 } }.with_timestamp_echo( 400 ) );
+      test.execute( ExpectSmoothedRTT { 94 } );
+      test.execute( ExpectRetransmissionTimeout { 294 } );
+
+      // two samples from one window
+      test.execute( Push { "efgh" } );
+      test.execute( ExpectMessage {}.with_data( "efgh" ).with_timestamp( 450 ) );
+      test.execute( Tick { 10 } );
+      test.execute( Push { "ijkl" } );
+      test.execute( ExpectMessage {}.with_data( "ijkl" ).with_timestamp( 460 ) );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 9 } }.with_timestamp_echo( 450 ) );
+      test.execute( ExpectSmoothedRTT { 85 } );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 13 } }.with_timestamp_echo( 460 ) );
+      test.execute( ExpectSmoothedRTT { 76 } );
+
+      // an ACK that acknowledges nothing new is not a sample
+      test.execute( Tick { 500 } );
+      test.execute( AckReceived { Wrap32 { isn + 13 } }.with_timestamp_echo( 460 ) );
+      test.execute( ExpectSmoothedRTT { 76 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
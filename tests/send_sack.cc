@@ -0,0 +1,184 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// An ACK of `ackno` that also SACKs the given [left, right) blocks
+static Receive sack( Wrap32 ackno, vector<SackBlock> blocks )
+{
+  TCPReceiverMessage msg { ackno, DEFAULT_TEST_WINDOW };
+  msg.sack = move( blocks );
+  return Receive { msg };
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Only the holes below enough SACKed data are retransmitted", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      // eight 10-byte segments
+      for ( uint32_t i = 0; i < 8; ++i ) {
+        test.execute( Push { string( 10, static_cast<char>( 'a' + i ) ) } );
+        test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 + 10 * i ).with_payload_size( 10 ) );
+      }
+
+      // the receiver has the 2nd, 4th, 6th and 8th: one block isn't enough to call anything lost
+      test.execute( sack( isn + 1, { { isn + 11, isn + 21 } } ) );
+      test.execute( ExpectNoSegment {} );
+
+      // with four blocks, the 1st and 3rd segments (each below at least three blocks) are lost
+      test.execute(
+        sack( isn + 1, { { isn + 11, isn + 21 }, { isn + 31, isn + 41 }, { isn + 51, isn + 61 }, { isn + 71, isn + 81 } } ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_data( string( 10, 'a' ) ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 21 ).with_data( string( 10, 'c' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 80 } );
+
+      // the same information again doesn't retransmit them again
+      test.execute(
+        sack( isn + 1, { { isn + 11, isn + 21 }, { isn + 31, isn + 41 }, { isn + 51, isn + 61 }, { isn + 71, isn + 81 } } ) );
+      test.execute( ExpectNoSegment {} );
+
+      // once the 1st and 3rd arrive, the remaining hole (5th) is below only two blocks
+      test.execute( sack( isn + 41, { { isn + 51, isn + 61 }, { isn + 71, isn + 81 } } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 40 } );
+
+      test.execute( AckReceived { Wrap32 { isn + 81 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "A retransmission timeout forgets the SACK scoreboard", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      for ( uint32_t i = 0; i < 8; ++i ) {
+        test.execute( Push { string( 10, static_cast<char>( 'a' + i ) ) } );
+        test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 + 10 * i ).with_payload_size( 10 ) );
+      }
+
+      // the 2nd, 4th and 6th are SACKed, so the 1st is lost
+      test.execute( sack( isn + 1, { { isn + 11, isn + 21 }, { isn + 31, isn + 41 }, { isn + 51, isn + 61 } } ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_data( string( 10, 'a' ) ) );
+      test.execute( ExpectNoSegment {} );
+
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_data( string( 10, 'a' ) ) );
+
+      // the receiver may have reneged on the old blocks: only the new one counts, and the 3rd isn't lost
+      test.execute( sack( isn + 11, { { isn + 71, isn + 81 } } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 70 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+      const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+      TCPSenderTestHarness test { "SACKed data doesn't count against the congestion window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 20 * mss, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // the 2nd segment is SACKed: one more segment of new data may go out
+      TCPReceiverMessage msg { Wrap32 { isn + 1 }, 60000 };
+      msg.sack = { { Wrap32 { isn + 1 + mss }, Wrap32 { isn + 1 + 2 * mss } } };
+      test.execute( Receive { msg } );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 + 10 * mss ).with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 11 * mss } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+      const uint64_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+      TCPSenderTestHarness test { "With SACK, fast recovery is paced by the pipe, not window inflation", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 20 * mss, 'x' ) } );
+      for ( unsigned i = 0; i < 10; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( mss ) );
+      }
+      test.execute( ExpectNoSegment {} );
+
+      // the 1st segment is lost; the k-th duplicate ACK SACKs the 2nd through (k+1)-th
+      const auto dup_ack = [&]( uint64_t k ) {
+        TCPReceiverMessage msg { Wrap32 { isn + 1 }, 60000 };
+        msg.sack = { { Wrap32 { isn + 1 + mss }, Wrap32 { isn + 1 + ( k + 1 ) * mss } } };
+        return Receive { msg };
+      };
+
+      // before the loss is detected each SACKed segment makes room for one new one
+      for ( uint64_t k = 1; k <= 2; ++k ) {
+        test.execute( dup_ack( k ) );
+        test.execute(
+          ExpectMessage {}.with_no_flags().with_seqno( isn + 1 + ( 9 + k ) * mss ).with_payload_size( mss ) );
+        test.execute( ExpectNoSegment {} );
+      }
+
+      // the third retransmits the hole and halves the 12-segment flight, without the 3 MSS inflation
+      test.execute( dup_ack( 3 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_payload_size( mss ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+
+      // the pipe (12 segments less the SACKed ones) must drain below the window first...
+      for ( uint64_t k = 4; k <= 6; ++k ) {
+        test.execute( dup_ack( k ) );
+        test.execute( ExpectNoSegment {} );
+      }
+      // ...and then each duplicate ACK releases exactly one segment
+      for ( uint64_t k = 7; k <= 9; ++k ) {
+        test.execute( dup_ack( k ) );
+        test.execute(
+          ExpectMessage {}.with_no_flags().with_seqno( isn + 1 + ( 5 + k ) * mss ).with_payload_size( mss ) );
+        test.execute( ExpectNoSegment {} );
+        test.execute( ExpectCongestionWindow { 6 * mss } );
+      }
+
+      // the retransmission arrives: recovery ends
+      test.execute( AckReceived { Wrap32 { isn + 1 + 10 * mss } }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 6 * mss } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -140,6 +140,23 @@ int main()
       test.execute( ExpectMessage {}.with_fin( true ).with_data( "4567" ) );
       test.execute( ExpectNoSegment {} );
     }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.send_capacity = 1 << 20;
+
+      TCPSenderTestHarness test { "Scaled window lets more than 64 KiB into flight", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( SetWindowScale { 4 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) ); // 160000 bytes
+      test.execute( Push { string( 200000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 160000 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 + 160000 } }.with_win( 1 ) ); // 16 bytes
+      test.execute( ExpectSeqnosInFlight { 16 } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -54,6 +54,48 @@ struct ExpectSeqnosInFlight : public ExpectNumber<StreamAndSender, uint64_t>
   uint64_t value( StreamAndSender& ss ) const override { return ss.second.sequence_numbers_in_flight(); }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.congestion_window(); }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "slow_start_threshold"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.slow_start_threshold(); }
+};
+
+struct ExpectSmoothedRTT : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "smoothed_rtt"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.smoothed_rtt(); }
+};
+
+struct ExpectRetransmissionTimeout : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "retransmission_timeout"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.retransmission_timeout(); }
+};
+
+struct ExpectPacingRate : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "pacing_rate"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.pacing_rate(); }
+};
+
+struct ExpectSegmentSize : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "segment_size"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.segment_size(); }
+};
+
 struct ExpectNoSegment : public Expectation<StreamAndSender>
 {
   std::string description() const override { return "nothing to send"; }
@@ -154,7 +196,11 @@ struct Receive : public Action<StreamAndSender>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    if ( msg_.timestamp_echo.has_value() ) {
+      desc << ", tsecr=" << msg_.timestamp_echo.value();
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -167,6 +213,12 @@ struct Receive : public Action<StreamAndSender>
     return *this;
   }
 
+  Receive& with_timestamp_echo( uint32_t tsecr )
+  {
+    msg_.timestamp_echo = tsecr;
+    return *this;
+  }
+
   void execute( StreamAndSender& ss ) const override
   {
     ss.second.receive( msg_ );
@@ -187,6 +239,24 @@ struct AckReceived : public Receive
   explicit AckReceived( Wrap32 ackno ) : Receive( { ackno, DEFAULT_TEST_WINDOW } ) {}
 };
 
+struct SetWindowScale : public Action<StreamAndSender>
+{
+  uint8_t shift_;
+
+  explicit SetWindowScale( uint8_t shift ) : shift_( shift ) {}
+  std::string description() const override { return "window scale set to " + std::to_string( shift_ ); }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_window_scale( shift_ ); }
+};
+
+struct SetMss : public Action<StreamAndSender>
+{
+  uint64_t mss_;
+
+  explicit SetMss( uint64_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "MSS set to " + std::to_string( mss_ ); }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_mss( mss_ ); }
+};
+
 struct Close : public Push
 {
   Close() : Push( "" ) { with_close(); }
@@ -199,6 +269,7 @@ struct ExpectMessage : public Expectation<StreamAndSender>
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
+  std::optional<std::optional<uint32_t>> timestamp {};
 
   ExpectMessage& with_syn( bool syn_ )
   {
@@ -239,6 +310,12 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     return *this;
   }
 
+  ExpectMessage& with_timestamp( std::optional<uint32_t> timestamp_ )
+  {
+    timestamp = timestamp_;
+    return *this;
+  }
+
   std::string message_description() const
   {
     std::ostringstream o;
@@ -261,6 +338,9 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     if ( fin.has_value() ) {
       o << ( fin.value() ? " +FIN" : " (no FIN)" );
     }
+    if ( timestamp.has_value() ) {
+      o << " tsval=" << to_string( timestamp.value() );
+    }
     return o.str();
   }
 
@@ -287,10 +367,13 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     if ( seqno.has_value() and seg.seqno != seqno.value() ) {
       throw ExpectationViolation( "sequence number", seqno.value(), seg.seqno );
     }
+    if ( timestamp.has_value() and seg.timestamp != timestamp.value() ) {
+      throw ExpectationViolation( "timestamp", timestamp.value(), seg.timestamp );
+    }
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.second.max_segment_size() ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -307,6 +390,6 @@ public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
                    "initial_RTO_ms=" + to_string( config.rt_timeout ),
-                   { ByteStream { config.send_capacity }, TCPSender { config.rt_timeout, config.fixed_isn } } )
+                   { ByteStream { config.send_capacity }, TCPSender { config } } )
   {}
 };
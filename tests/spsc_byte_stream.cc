@@ -0,0 +1,150 @@
+#include "eventloop.hh"
+#include "random.hh"
+#include "spsc_byte_stream.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+// Producer and consumer on separate threads, each pushing/popping random amounts.
+// With `events`, both sides sleep in an EventLoop on the stream's eventfds instead of spinning.
+void stress_test( const size_t input_len, const size_t capacity, const bool events )
+{
+  auto rd = get_random_engine();
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  SPSCByteStream stream { capacity, events };
+  const auto write_seed = rd();
+  const auto read_seed = rd();
+
+  thread producer { [&] {
+    default_random_engine wrd { write_seed };
+    uniform_int_distribution<size_t> write_size { 1, 2 * capacity };
+    SPSCWriter& writer = stream.writer();
+    size_t pushed = 0;
+
+    const auto push_some = [&] {
+      while ( pushed < data.size() ) {
+        const auto len = writer.push( string_view { data }.substr( pushed, write_size( wrd ) ) );
+        if ( len == 0 ) {
+          break;
+        }
+        pushed += len;
+      }
+      if ( pushed == data.size() and not writer.is_closed() ) {
+        writer.close();
+      }
+    };
+
+    if ( not events ) {
+      while ( not writer.is_closed() ) {
+        push_some();
+        this_thread::yield();
+      }
+      return;
+    }
+
+    EventLoop loop;
+    loop.add_rule(
+      "push when space is freed",
+      stream.writable_event(),
+      Direction::In,
+      [&] {
+        writer.ack_writable_event();
+        push_some();
+      },
+      [&] { return not writer.is_closed(); } );
+    push_some();
+    while ( loop.wait_next_event( -1 ) != EventLoop::Result::Exit ) {}
+  } };
+
+  string output;
+  output.reserve( data.size() );
+  default_random_engine rrd { read_seed };
+  SPSCReader& reader = stream.reader();
+
+  const auto pop_some = [&] {
+    while ( reader.bytes_buffered() ) {
+      const auto regions = reader.peek_iov();
+      // the writer may push in between, so peek() can only have grown
+      if ( regions.empty() or not reader.peek().starts_with( regions.front() ) ) {
+        throw runtime_error( "SPSCReader::peek_iov() disagrees with peek()" );
+      }
+      const auto len = uniform_int_distribution<size_t> { 1, regions.front().size() }( rrd );
+      output += regions.front().substr( 0, len );
+      reader.pop( len );
+    }
+  };
+
+  if ( events ) {
+    EventLoop loop;
+    loop.add_rule(
+      "pop when bytes are pushed",
+      stream.readable_event(),
+      Direction::In,
+      [&] {
+        reader.ack_readable_event();
+        pop_some();
+      },
+      [&] { return not reader.is_finished(); } );
+    while ( loop.wait_next_event( -1 ) != EventLoop::Result::Exit ) {}
+  } else {
+    while ( not reader.is_finished() ) {
+      pop_some();
+      this_thread::yield();
+    }
+  }
+
+  producer.join();
+
+  if ( output != data ) {
+    throw runtime_error( "SPSCByteStream: mismatch between data written and read (capacity="
+                         + to_string( capacity ) + ", events=" + to_string( events ) + ")" );
+  }
+  if ( stream.reader().bytes_popped() != input_len or stream.writer().bytes_pushed() != input_len ) {
+    throw runtime_error( "SPSCByteStream: wrong byte counts" );
+  }
+}
+
+int main()
+{
+  try {
+    for ( const bool events : { false, true } ) {
+      stress_test( 1, 1, events );
+      stress_test( 100000, 7, events );
+      stress_test( 1000000, 4096, events );
+      stress_test( 1000000, 65536, events );
+    }
+
+    // acknowledging an event that was never signaled is a no-op
+    SPSCByteStream quiet { 16, true };
+    quiet.reader().ack_readable_event();
+    quiet.writer().ack_writable_event();
+
+    // set_error is seen by the consumer
+    SPSCByteStream stream { 16 };
+    thread producer { [&] { stream.writer().set_error(); } };
+    producer.join();
+    if ( not stream.reader().has_error() ) {
+      throw runtime_error( "SPSCByteStream: set_error() not seen by the reader" );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
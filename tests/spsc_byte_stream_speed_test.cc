@@ -0,0 +1,163 @@
+#include "eventloop.hh"
+#include "exception.hh"
+#include "spsc_byte_stream.hh"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sys/socket.h>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+static string make_data( const size_t input_len )
+{
+  default_random_engine rd { 1234 };
+  uniform_int_distribution<char> ud;
+  string ret;
+  for ( size_t i = 0; i < input_len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
+
+static void report( const string& name, const size_t input_len, const size_t write_size, const double seconds )
+{
+  const auto gigabits_per_second = 8 * static_cast<double>( input_len ) / seconds / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << name << " with write_size=" << write_size << " reached " << fixed << setprecision( 2 )
+       << gigabits_per_second << " Gbit/s.\n";
+  debug_output << "             " << name << " throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s\n";
+}
+
+// Owner thread -> TCP thread over the lock-free stream, both sides sleeping on its eventfds
+double spsc_speed_test( const string& data, const size_t capacity, const size_t write_size )
+{
+  SPSCByteStream stream { capacity, true };
+  string output;
+  output.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+
+  thread producer { [&] {
+    SPSCWriter& writer = stream.writer();
+    size_t pushed = 0;
+    const auto push_some = [&] {
+      while ( pushed < data.size() ) {
+        const auto len = writer.push( string_view { data }.substr( pushed, write_size ) );
+        if ( len == 0 ) {
+          return;
+        }
+        pushed += len;
+      }
+      writer.close();
+    };
+
+    EventLoop loop;
+    loop.add_rule(
+      "push",
+      stream.writable_event(),
+      Direction::In,
+      [&] {
+        writer.ack_writable_event();
+        push_some();
+      },
+      [&] { return not writer.is_closed(); } );
+    push_some();
+    while ( loop.wait_next_event( -1 ) != EventLoop::Result::Exit ) {}
+  } };
+
+  SPSCReader& reader = stream.reader();
+  EventLoop loop;
+  loop.add_rule(
+    "pop",
+    stream.readable_event(),
+    Direction::In,
+    [&] {
+      reader.ack_readable_event();
+      for ( const auto region : reader.peek_iov() ) {
+        output += region;
+        reader.pop( region.size() );
+      }
+    },
+    [&] { return not reader.is_finished(); } );
+  while ( loop.wait_next_event( -1 ) != EventLoop::Result::Exit ) {}
+
+  producer.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( output != data ) {
+    throw runtime_error( "SPSCByteStream: mismatch between data written and read" );
+  }
+
+  return duration_cast<duration<double>>( stop_time - start_time ).count();
+}
+
+// The same transfer through an AF_UNIX socketpair (TCPMinnowSocket's _thread_data path)
+double socketpair_speed_test( const string& data, const size_t write_size )
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "socketpair", ::socketpair( AF_UNIX, SOCK_STREAM, 0, fds.data() ) );
+  FileDescriptor owner_side { fds[0] };
+  FileDescriptor tcp_side { fds[1] };
+
+  string output;
+  output.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+
+  thread producer { [&] {
+    for ( size_t pushed = 0; pushed < data.size(); ) {
+      pushed += owner_side.write( string_view { data }.substr( pushed, write_size ) );
+    }
+    owner_side.close();
+  } };
+
+  string buffer;
+  while ( not tcp_side.eof() ) {
+    buffer.clear();
+    tcp_side.read( buffer );
+    output += buffer;
+  }
+
+  producer.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( output != data ) {
+    throw runtime_error( "socketpair: mismatch between data written and read" );
+  }
+
+  return duration_cast<duration<double>>( stop_time - start_time ).count();
+}
+
+void program_body()
+{
+  const size_t input_len = 1e8;
+  const string data = make_data( input_len );
+
+  for ( const size_t write_size : { 1500, 16384 } ) {
+    report( "SPSCByteStream", input_len, write_size, spsc_speed_test( data, 65536, write_size ) );
+    report( "socketpair", input_len, write_size, socketpair_speed_test( data, write_size ) );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Receive-buffer auto-tuning: a TCPPeer grows its inbound capacity while the application keeps up with a
+// window-limited sender, not for an application that doesn't read, and shrinks it again once idle
+
+namespace {
+
+constexpr uint32_t PEER_ISN = 1000;
+constexpr uint64_t RTT_MS = 50;
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "TCPPeer auto-tuning: " + what );
+  }
+}
+
+// A connection accepted from a peer that uses timestamps and window scaling, and always fills our window
+struct Connection
+{
+  TCPConfig cfg;
+  TCPPeer peer { cfg };
+  Wrap32 our_next { 0 };
+  uint64_t peer_sent { 0 };  // bytes of the peer's stream it sent (it goes back to our ackno)
+  uint64_t window_end { 0 }; // as far into the peer's stream as our last ACK lets it send
+  uint32_t echo { 0 };       // the timestamp of our last ACK, which the peer echoes
+
+  explicit Connection( const TCPConfig& config ) : cfg( config )
+  {
+    TCPSegment syn;
+    syn.sender_message.seqno = Wrap32 { PEER_ISN };
+    syn.sender_message.SYN = true;
+    syn.sender_message.timestamp = 1;
+    syn.receiver_message.window_size = UINT16_MAX;
+    syn.window_scale = 0;
+    peer.receive( syn );
+
+    const auto syn_ack = peer.maybe_send();
+    expect( syn_ack.has_value() and syn_ack->sender_message.SYN, "no SYN-ACK" );
+    our_next = syn_ack->sender_message.seqno + 1;
+    take_ack( *syn_ack, 0 );
+  }
+
+  void take_ack( const TCPSegment& ack, uint8_t shift )
+  {
+    expect( ack.sender_message.timestamp.has_value(), "ACK without a timestamp" );
+    echo = *ack.sender_message.timestamp;
+    peer_sent = peer.inbound_reader().bytes_popped() + peer.inbound_reader().bytes_buffered();
+    window_end = peer_sent + ( uint64_t { ack.receiver_message.window_size } << shift );
+  }
+
+  // A round trip: our last ACK reaches the peer, which sends a window's worth of data back; the
+  // application reads up to `read` bytes of it, and we ACK
+  void round( uint64_t read )
+  {
+    peer.tick( RTT_MS );
+    while ( peer_sent < window_end ) {
+      TCPSegment seg;
+      seg.sender_message.seqno = Wrap32::wrap( peer_sent, Wrap32 { PEER_ISN + 1 } );
+      seg.sender_message.payload = string( min<uint64_t>( 1000, window_end - peer_sent ), 'x' );
+      seg.sender_message.timestamp = 2;
+      seg.receiver_message.ackno = our_next;
+      seg.receiver_message.window_size = UINT16_MAX;
+      seg.receiver_message.timestamp_echo = echo;
+      peer_sent += seg.sender_message.payload.size();
+      peer.receive( seg );
+    }
+    peer.inbound_reader().pop( min( read, peer.inbound_reader().bytes_buffered() ) );
+    while ( const auto ack = peer.maybe_send() ) {
+      take_ack( *ack, cfg.window_scale() );
+    }
+  }
+};
+
+TCPConfig autotuning_config()
+{
+  TCPConfig cfg;
+  cfg.recv_autotuning = true;
+  cfg.delayed_ack = false;
+  return cfg;
+}
+
+void window_scale_test()
+{
+  const TCPConfig cfg = autotuning_config();
+  expect( ( uint64_t { UINT16_MAX } << cfg.window_scale() ) >= cfg.recv_capacity_max,
+          "the window scale doesn't cover recv_capacity_max" );
+}
+
+void grow_test()
+{
+  Connection c { autotuning_config() };
+  uint64_t previous = c.peer.recv_capacity();
+  expect( previous == c.cfg.recv_capacity, "doesn't start at recv_capacity" );
+  for ( int i = 0; i < 3; ++i ) {
+    c.round( UINT64_MAX );
+  }
+  expect( c.peer.recv_capacity() > previous, "capacity didn't grow for a reader that keeps up" );
+  for ( int i = 0; i < 20; ++i ) {
+    previous = c.peer.recv_capacity();
+    c.round( UINT64_MAX );
+    expect( c.peer.recv_capacity() <= 2 * previous, "capacity more than doubled in a round trip" );
+  }
+  expect( c.peer.recv_capacity() == c.cfg.recv_capacity_max, "capacity didn't reach recv_capacity_max" );
+  expect( c.window_end - c.peer_sent > c.cfg.recv_capacity_max / 2, "the advertised window didn't grow" );
+}
+
+void slow_reader_test()
+{
+  Connection c { autotuning_config() };
+  for ( int i = 0; i < 20; ++i ) {
+    c.round( 1000 );
+  }
+  expect( c.peer.recv_capacity() == c.cfg.recv_capacity, "capacity grew for a slow reader" );
+}
+
+void idle_test()
+{
+  Connection c { autotuning_config() };
+  for ( int i = 0; i < 10; ++i ) {
+    c.round( UINT64_MAX );
+  }
+  expect( c.peer.recv_capacity() > c.cfg.recv_capacity, "capacity didn't grow" );
+  c.peer.tick( 999 ); // a second after the last data arrived
+  expect( c.peer.recv_capacity() > c.cfg.recv_capacity, "capacity shrank too early" );
+  c.peer.tick( 1 );
+  expect( c.peer.recv_capacity() == c.cfg.recv_capacity, "idle connection kept its capacity" );
+
+  // and it grows again once data flows
+  for ( int i = 0; i < 5; ++i ) {
+    c.round( UINT64_MAX );
+  }
+  expect( c.peer.recv_capacity() > c.cfg.recv_capacity, "capacity didn't grow again" );
+}
+
+void disabled_test()
+{
+  TCPConfig cfg = autotuning_config();
+  cfg.recv_autotuning = false;
+  Connection c { cfg };
+  for ( int i = 0; i < 10; ++i ) {
+    c.round( UINT64_MAX );
+  }
+  expect( c.peer.recv_capacity() == cfg.recv_capacity, "capacity changed with auto-tuning disabled" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    window_scale_test();
+    grow_test();
+    slow_reader_test();
+    idle_test();
+    disabled_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
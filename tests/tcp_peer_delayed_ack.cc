@@ -0,0 +1,149 @@
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// When a TCPPeer acknowledges data: every second in-order segment, after the delayed-ACK timeout,
+// right away for anything out of order or a FIN, and never separately once data carried the ACK
+
+namespace {
+
+constexpr uint32_t PEER_ISN = 1000;
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "TCPPeer delayed ACK: " + what );
+  }
+}
+
+// A connection accepted from a peer (which uses no options), with its handshake done
+struct Connection
+{
+  TCPPeer peer;
+  Wrap32 our_next { 0 };
+
+  explicit Connection( const TCPConfig& cfg ) : peer( cfg )
+  {
+    TCPSegment syn;
+    syn.sender_message.seqno = Wrap32 { PEER_ISN };
+    syn.sender_message.SYN = true;
+    syn.receiver_message.window_size = UINT16_MAX;
+    peer.receive( syn );
+
+    const auto syn_ack = peer.maybe_send();
+    expect( syn_ack.has_value() and syn_ack->sender_message.SYN, "no SYN-ACK" );
+    our_next = syn_ack->sender_message.seqno + 1;
+  }
+
+  // Data from the peer, `offset` bytes into its stream
+  void data( uint32_t offset, const string& payload, bool fin = false )
+  {
+    TCPSegment seg;
+    seg.sender_message.seqno = Wrap32 { PEER_ISN + 1 + offset };
+    seg.sender_message.payload = payload;
+    seg.sender_message.FIN = fin;
+    seg.receiver_message.ackno = our_next;
+    seg.receiver_message.window_size = UINT16_MAX;
+    peer.receive( seg );
+  }
+
+  // Expect a pure ACK of `offset` bytes of the peer's stream (plus its SYN, and FIN if `fin`)
+  void expect_ack( uint32_t offset, const string& what, bool fin = false )
+  {
+    const auto seg = peer.maybe_send();
+    expect( seg.has_value(), what + ": no ACK" );
+    expect( seg->sender_message.sequence_length() == 0, what + ": not a pure ACK" );
+    expect( seg->receiver_message.ackno == Wrap32 { PEER_ISN + 1 + offset + fin }, what + ": wrong ackno" );
+    expect( not peer.maybe_send().has_value(), what + ": more than one ACK" );
+  }
+
+  void expect_nothing( const string& what ) { expect( not peer.maybe_send().has_value(), what ); }
+};
+
+void every_second_segment_test()
+{
+  Connection c { TCPConfig {} };
+  c.data( 0, string( 100, 'a' ) );
+  c.expect_nothing( "first segment ACKed right away" );
+  c.data( 100, string( 100, 'b' ) );
+  c.expect_ack( 200, "second segment" );
+  c.data( 200, string( 100, 'c' ) );
+  c.expect_nothing( "third segment ACKed right away" );
+  c.data( 300, string( 100, 'd' ) );
+  c.expect_ack( 400, "fourth segment" );
+}
+
+void timeout_test()
+{
+  TCPConfig cfg;
+  Connection c { cfg };
+  c.data( 0, string( 100, 'a' ) );
+  expect( c.peer.next_deadline() == cfg.delayed_ack_timeout, "next_deadline() is not the delayed-ACK timer" );
+  c.peer.tick( cfg.delayed_ack_timeout - 1 );
+  c.expect_nothing( "ACK sent before the timeout" );
+  c.peer.tick( 1 );
+  c.expect_ack( 100, "after the timeout" );
+  c.peer.tick( 10 * cfg.delayed_ack_timeout );
+  c.expect_nothing( "timer still armed after the ACK" );
+}
+
+void immediate_test()
+{
+  Connection c { TCPConfig {} };
+  c.data( 100, string( 100, 'b' ) );
+  c.expect_ack( 0, "out-of-order segment (duplicate ACK)" );
+  c.data( 0, string( 100, 'a' ) );
+  c.expect_ack( 200, "segment filling the hole" );
+  c.data( 200, string( 100, 'c' ), true );
+  c.expect_ack( 300, "FIN", true );
+}
+
+void piggyback_test()
+{
+  TCPConfig cfg;
+  Connection c { cfg };
+  c.data( 0, string( 100, 'a' ) );
+  c.peer.outbound_writer().push( "reply" );
+  const auto seg = c.peer.maybe_send();
+  expect( seg.has_value() and seg->sender_message.payload.size() == 5, "no data segment" );
+  expect( seg->receiver_message.ackno == Wrap32 { PEER_ISN + 1 + 100 }, "data segment doesn't carry the ACK" );
+  c.peer.tick( cfg.delayed_ack_timeout );
+  c.expect_nothing( "separate ACK after a piggybacked one" );
+}
+
+void disabled_test()
+{
+  TCPConfig cfg;
+  cfg.delayed_ack = false;
+  Connection c { cfg };
+  c.data( 0, string( 100, 'a' ) );
+  c.expect_ack( 100, "with delayed ACKs disabled" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    every_second_segment_test();
+    timeout_test();
+    immediate_test();
+    piggyback_test();
+    disabled_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
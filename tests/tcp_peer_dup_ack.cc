@@ -0,0 +1,122 @@
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Only ACKs without data count as duplicate ACKs (RFC 5681 2): when data flows both ways, the peer's data
+// segments repeat its ackno without anything being lost
+
+namespace {
+
+constexpr uint32_t PEER_ISN = 1000;
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "TCPPeer duplicate ACKs: " + what );
+  }
+}
+
+// A connection accepted from a peer (which uses no options), with three segments of our data in flight
+struct Connection
+{
+  TCPPeer peer;
+  Wrap32 our_next { 0 };
+  uint32_t peer_offset { 0 };
+
+  explicit Connection( const TCPConfig& cfg ) : peer( cfg )
+  {
+    TCPSegment syn;
+    syn.sender_message.seqno = Wrap32 { PEER_ISN };
+    syn.sender_message.SYN = true;
+    syn.receiver_message.window_size = UINT16_MAX;
+    peer.receive( syn );
+
+    const auto syn_ack = peer.maybe_send();
+    expect( syn_ack.has_value() and syn_ack->sender_message.SYN, "no SYN-ACK" );
+    our_next = syn_ack->sender_message.seqno + 1;
+    ack( "" ); // of the SYN-ACK
+
+    const uint64_t mss = peer.sender().segment_size(); // the default for a peer without the MSS option
+    peer.outbound_writer().push( string( 3 * mss, 'x' ) );
+    for ( int i = 0; i < 3; ++i ) {
+      const auto seg = peer.maybe_send();
+      expect( seg.has_value() and seg->sender_message.payload.size() == mss,
+              "data segment " + to_string( i ) + " not sent" );
+    }
+    expect( peer.sender().sequence_numbers_in_flight() == 3 * mss, "data in flight" );
+  }
+
+  // A segment from the peer carrying `payload` and acknowledging only our SYN
+  void ack( const string& payload )
+  {
+    TCPSegment seg;
+    seg.sender_message.seqno = Wrap32 { PEER_ISN + 1 + peer_offset };
+    seg.sender_message.payload = payload;
+    seg.receiver_message.ackno = our_next;
+    seg.receiver_message.window_size = UINT16_MAX;
+    peer.receive( seg );
+    peer_offset += payload.size();
+  }
+
+  // Whether anything we send now retransmits our data
+  bool retransmits()
+  {
+    bool any = false;
+    while ( const auto seg = peer.maybe_send() ) {
+      any |= not seg->sender_message.payload.empty();
+    }
+    return any;
+  }
+};
+
+TCPConfig reno()
+{
+  TCPConfig cfg;
+  cfg.congestion_control = TCPConfig::CongestionControl::Reno;
+  return cfg;
+}
+
+void data_test()
+{
+  Connection c { reno() };
+  const uint64_t cwnd = c.peer.sender().congestion_window();
+  for ( unsigned i = 0; i < TCPConfig::DUP_ACK_THRESHOLD + 1; ++i ) {
+    c.ack( string( 100, 'a' ) );
+  }
+  expect( not c.retransmits(), "data segments from the peer triggered a fast retransmit" );
+  expect( c.peer.sender().congestion_window() == cwnd, "data segments from the peer cut the window" );
+}
+
+void pure_ack_test()
+{
+  Connection c { reno() };
+  for ( unsigned i = 0; i < TCPConfig::DUP_ACK_THRESHOLD; ++i ) {
+    c.ack( "" );
+  }
+  expect( c.retransmits(), "duplicate ACKs did not trigger a fast retransmit" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    data_test();
+    pure_ack_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
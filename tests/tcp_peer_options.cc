@@ -0,0 +1,115 @@
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// How the options a TCPPeer negotiates limit the segments it sends
+
+namespace {
+
+constexpr uint32_t PEER_ISN = 1000;
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "TCPPeer: " + what );
+  }
+}
+
+size_t wire_size( TCPSegment seg )
+{
+  seg.compute_checksum( 0 );
+  Serializer serializer;
+  seg.serialize( serializer );
+  size_t size = 0;
+  for ( const auto& buf : serializer.output() ) {
+    size += buf.size();
+  }
+  return size;
+}
+
+// Send our SYN, and answer it with a SYN-ACK carrying `peer_mss` (and timestamps and SACK-permitted)
+void handshake( TCPPeer& peer, optional<uint16_t> peer_mss )
+{
+  peer.push();
+  const auto syn = peer.maybe_send();
+  expect( syn.has_value() and syn->sender_message.SYN, "no SYN" );
+
+  TCPSegment syn_ack;
+  syn_ack.sender_message.seqno = Wrap32 { PEER_ISN };
+  syn_ack.sender_message.SYN = true;
+  syn_ack.sender_message.timestamp = 5;
+  syn_ack.receiver_message.ackno = syn->sender_message.seqno + 1;
+  syn_ack.receiver_message.window_size = UINT16_MAX;
+  syn_ack.receiver_message.timestamp_echo = syn->sender_message.timestamp;
+  syn_ack.mss = peer_mss;
+  syn_ack.sack_permitted = true;
+  peer.receive( syn_ack );
+}
+
+// A peer advertising an absurdly small MSS doesn't make the payload size underflow
+void tiny_mss_test()
+{
+  TCPConfig cfg;
+  TCPPeer peer { cfg };
+  handshake( peer, 0 );
+
+  peer.outbound_writer().push( string( 1000, 'x' ) );
+  const auto seg = peer.maybe_send();
+  expect( seg.has_value(), "no data segment" );
+  expect( seg->sender_message.payload.size() == TCPConfig::MIN_PEER_MSS - 12,
+          "payload of " + to_string( seg->sender_message.payload.size() ) + " bytes for an MSS of 0" );
+}
+
+// A full-size segment leaves no room for SACK blocks; a shorter one carries them, and neither exceeds the MSS
+void sack_room_test()
+{
+  TCPConfig cfg;
+  cfg.mss = 1460;
+  TCPPeer peer { cfg };
+  handshake( peer, 1460 );
+  while ( peer.maybe_send() ) {} // the ACK of the SYN-ACK
+
+  // data from the peer arrives out of order, so our ACKs SACK it
+  TCPSegment data;
+  data.sender_message.seqno = Wrap32 { PEER_ISN + 1 + 100 };
+  data.sender_message.payload = string( 50, 'y' );
+  data.sender_message.timestamp = 6;
+  data.receiver_message.ackno = peer.sender().send_empty_message().seqno;
+  data.receiver_message.window_size = UINT16_MAX;
+  peer.receive( data );
+
+  peer.outbound_writer().push( string( 1448 + 10, 'x' ) );
+  const auto full = peer.maybe_send();
+  const auto rest = peer.maybe_send();
+  expect( full.has_value() and rest.has_value(), "data segments missing" );
+  expect( full->sender_message.payload.size() == 1448, "full-size payload is not MSS less the timestamps" );
+  expect( full->receiver_message.sack.empty(), "full-size segment carries SACK blocks" );
+  expect( wire_size( *full ) <= 20 + 1460, "full-size segment exceeds the MSS" );
+  expect( rest->receiver_message.sack.size() == 1, "short segment lost its SACK block" );
+  expect( wire_size( *rest ) <= 20 + 1460, "short segment exceeds the MSS" );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    tiny_mss_test();
+    sack_room_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
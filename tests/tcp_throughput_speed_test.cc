@@ -0,0 +1,183 @@
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Bulk transfer between two TCPPeers over an emulated path with a 50 ms round trip (and no bandwidth
+// limit or loss), in virtual time. Without window scaling the 16-bit window caps throughput at about
+// 64 KiB per RTT whatever the capacity; with it, throughput grows with the capacity. Delayed ACKs
+// halve the segments the receiving side sends. Receive-buffer auto-tuning starts from a small capacity
+// and only grows it as far as the application's reading rate needs (peak_recv_capacity is the memory the
+// receiving connection used), giving it back once the connection is idle. Prints CSV.
+
+namespace {
+
+constexpr uint64_t ONE_WAY_DELAY_MS = 25;
+constexpr uint64_t TRANSFER_SIZE = 16 << 20;
+constexpr uint64_t VIRTUAL_TIME_LIMIT_MS = 600'000;
+constexpr uint64_t IDLE_MS = 1000;
+
+// One direction of the path: segments travel as bytes, so the options are serialized and parsed
+class Link
+{
+  deque<pair<uint64_t, vector<Buffer>>> in_transit_ {};
+  uint64_t segments_ {};
+
+public:
+  uint64_t segments() const { return segments_; }
+
+  void send( TCPSegment seg, uint64_t now_ms )
+  {
+    ++segments_;
+    seg.compute_checksum( 0 );
+    Serializer serializer;
+    seg.serialize( serializer );
+    in_transit_.emplace_back( now_ms + ONE_WAY_DELAY_MS, serializer.output() );
+  }
+
+  // Each segment is handled on its own, as if it arrived separately: `then` runs after each one
+  void deliver( TCPPeer& peer, uint64_t now_ms, const function<void()>& then )
+  {
+    while ( not in_transit_.empty() and in_transit_.front().first <= now_ms ) {
+      TCPSegment seg;
+      Parser parser { in_transit_.front().second };
+      seg.parse( parser, 0 );
+      if ( parser.has_error() ) {
+        throw runtime_error( "segment failed to parse" );
+      }
+      in_transit_.pop_front();
+      peer.receive( move( seg ) );
+      then();
+    }
+  }
+};
+
+void send_all( TCPPeer& peer, Link& link, uint64_t now_ms )
+{
+  while ( auto seg = peer.maybe_send() ) {
+    link.send( move( *seg ), now_ms );
+  }
+}
+
+// `reader_rate`: how many bytes the receiving application reads per millisecond (0: as fast as they arrive)
+void throughput_test( size_t capacity,
+                      bool window_scaling,
+                      bool delayed_ack,
+                      bool autotuning = false,
+                      uint64_t reader_rate = 0 )
+{
+  TCPConfig cfg;
+  cfg.recv_capacity = capacity;
+  cfg.window_scaling = window_scaling;
+  cfg.delayed_ack = delayed_ack;
+  cfg.recv_autotuning = autotuning;
+  cfg.send_capacity = autotuning ? cfg.recv_capacity_max : capacity;
+
+  TCPPeer client { cfg };
+  TCPPeer server { cfg };
+  Link uplink;
+  Link downlink;
+
+  const string chunk( 64 << 10, 'x' );
+  uint64_t pushed = 0;
+  uint64_t now_ms = 0;
+  uint64_t readable = 0; // bytes the application may still read this millisecond
+  uint64_t peak_recv_capacity = server.recv_capacity();
+
+  const auto start_time = steady_clock::now();
+
+  client.push(); // SYN
+  while ( server.inbound_reader().bytes_popped() < TRANSFER_SIZE ) {
+    if ( now_ms > VIRTUAL_TIME_LIMIT_MS ) {
+      throw runtime_error( "transfer did not finish" );
+    }
+
+    Writer& writer = client.outbound_writer();
+    while ( pushed < TRANSFER_SIZE and writer.available_capacity() > 0 ) {
+      const uint64_t len = min( { writer.available_capacity(), TRANSFER_SIZE - pushed, uint64_t { chunk.size() } } );
+      writer.push( chunk.substr( 0, len ) );
+      pushed += len;
+    }
+
+    send_all( client, uplink, now_ms );
+    readable = reader_rate > 0 ? reader_rate : UINT64_MAX;
+    uplink.deliver( server, now_ms, [&] {
+      const uint64_t len = min( readable, server.inbound_reader().bytes_buffered() );
+      server.inbound_reader().pop( len );
+      readable -= len;
+      send_all( server, downlink, now_ms );
+    } );
+    const uint64_t len = min( readable, server.inbound_reader().bytes_buffered() );
+    server.inbound_reader().pop( len );
+    send_all( server, downlink, now_ms ); // a delayed ACK whose timer expired
+    downlink.deliver( client, now_ms, [&] { send_all( client, uplink, now_ms ); } );
+
+    ++now_ms;
+    client.tick( 1 );
+    server.tick( 1 );
+    peak_recv_capacity = max( peak_recv_capacity, server.recv_capacity() );
+  }
+
+  const auto stop_time = steady_clock::now();
+  const double virtual_seconds = static_cast<double>( now_ms ) / 1000.0;
+  const double wall_seconds = duration_cast<duration<double>>( stop_time - start_time ).count();
+
+  // what the receiving connection holds on to once nothing arrives any more
+  for ( uint64_t idle = 0; idle < IDLE_MS; ++idle ) {
+    send_all( server, downlink, now_ms );
+    downlink.deliver( client, now_ms, [&] {} );
+    ++now_ms;
+    client.tick( 1 );
+    server.tick( 1 );
+  }
+
+  cout << capacity << "," << ( window_scaling ? "on" : "off" ) << "," << ( delayed_ack ? "on" : "off" ) << ","
+       << ( autotuning ? "on" : "off" ) << ","
+       << ( reader_rate > 0 ? to_string( reader_rate * 1000 / 1000000 ) : string { "max" } ) << "," << fixed
+       << setprecision( 2 ) << static_cast<double>( TRANSFER_SIZE ) / virtual_seconds / 1e6 << ","
+       << peak_recv_capacity << "," << server.recv_capacity() << "," << uplink.segments() << ","
+       << downlink.segments() << "," << setprecision( 3 ) << wall_seconds << "\n";
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    cout << "capacity,window_scaling,delayed_ack,autotuning,reader_MBps,MBps_at_50ms_rtt,peak_recv_capacity,"
+            "idle_recv_capacity,data_segments,ack_segments,wall_seconds\n";
+    for ( const size_t capacity : { 64000UL, 256UL << 10, 1UL << 20, 4UL << 20 } ) {
+      for ( const bool window_scaling : { false, true } ) {
+        throughput_test( capacity, window_scaling, true );
+      }
+    }
+    for ( const size_t capacity : { 64000UL, 4UL << 20 } ) {
+      throughput_test( capacity, true, false );
+    }
+    for ( const uint64_t reader_rate : { 0UL, 5000UL } ) { // as fast as it arrives, and 5 MB/s
+      throughput_test( 4UL << 20, true, true, false, reader_rate );
+      throughput_test( 64000, true, true, true, reader_rate );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+#include "random.hh"
+#include "timer_wheel.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "TimerWheel: " + what );
+  }
+}
+
+// Timers fire exactly at their deadline, whichever level of the wheel they start on
+void deadlines_test()
+{
+  TimerWheel<> wheel;
+  vector<uint64_t> fired;
+  const vector<uint64_t> delays { 1, 2, 255, 256, 257, 65535, 65536, 70000, 1 << 24, ( 1 << 24 ) + 3 };
+  for ( const uint64_t delay : delays ) {
+    wheel.schedule( delay, [&, delay] {
+      expect( wheel.now() == delay, "timer of " + to_string( delay ) + " ms fired at " + to_string( wheel.now() ) );
+      fired.push_back( delay );
+    } );
+  }
+  expect( wheel.size() == delays.size(), "size() after schedule" );
+
+  for ( uint64_t elapsed = 0; elapsed < ( 1 << 24 ) + 10; elapsed += 7 ) {
+    wheel.advance( 7 );
+  }
+  expect( fired == delays, "timers fired out of order or not at all" );
+  expect( wheel.empty(), "timers left after they all fired" );
+
+  // a delay of 0 waits for the next advance
+  bool fired_now = false;
+  wheel.schedule( 0, [&] { fired_now = true; } );
+  expect( not fired_now, "timer fired on schedule()" );
+  wheel.advance( 1 );
+  expect( fired_now, "timer of 0 ms did not fire on the next advance" );
+
+  // one big advance fires everything that expired in it, in deadline order
+  fired.clear();
+  for ( const uint64_t delay : { 300000, 5, 40000, 5 } ) {
+    wheel.schedule( delay, [&, delay] { fired.push_back( delay ); } );
+  }
+  wheel.advance( 1000000 );
+  expect( fired == vector<uint64_t> { 5, 5, 40000, 300000 }, "one long advance" );
+}
+
+// Deadlines beyond the reach of the wheel (2^32 ms) still fire on time
+void far_deadline_test()
+{
+  TimerWheel<> wheel;
+  const uint64_t delay = ( uint64_t { 1 } << 33 ) + 12345;
+  bool fired = false;
+  wheel.schedule( delay, [&] { fired = true; } );
+  wheel.advance( delay - 1 );
+  expect( not fired, "far timer fired early" );
+  wheel.advance( 1 );
+  expect( fired, "far timer did not fire at its deadline" );
+}
+
+// Cancelled timers never fire, and ids of fired or cancelled timers are stale (even once their node is reused)
+void cancel_test()
+{
+  TimerWheel<> wheel;
+  int fired = 0;
+  const auto a = wheel.schedule( 10, [&] { ++fired; } );
+  const auto b = wheel.schedule( 1000, [&] { ++fired; } );
+  expect( wheel.pending( a ) and wheel.pending( b ), "pending() after schedule" );
+  expect( wheel.cancel( b ), "cancel() of a pending timer" );
+  expect( not wheel.pending( b ) and not wheel.cancel( b ), "cancelled timer still pending" );
+
+  const auto c = wheel.schedule( 1000, [&] { fired += 100; } ); // reuses b's node
+  expect( not wheel.pending( b ) and wheel.pending( c ), "stale id aliases a new timer" );
+
+  wheel.advance( 10 );
+  expect( fired == 1 and not wheel.pending( a ) and not wheel.cancel( a ), "fired timer still pending" );
+  wheel.advance( 2000 );
+  expect( fired == 101 and wheel.empty(), "timers after cancel" );
+}
+
+// Callbacks may arm, re-arm and cancel timers, including ones that expire at the same time
+void callback_test()
+{
+  TimerWheel<int&> wheel;
+  int count = 0;
+
+  TimerWheel<int&>::Id victim;
+  wheel.schedule( 5, [&]( int& n ) {
+    ++n;
+    expect( wheel.cancel( victim ), "cancelling a timer of the same millisecond" );
+    wheel.schedule( 0, [&]( int& m ) { m += 10; } ); // fires one ms later
+  } );
+  victim = wheel.schedule( 5, []( int& n ) { n += 1000; } );
+
+  // a periodic timer that re-arms itself
+  function<void( int& )> periodic = [&]( int& n ) {
+    n += 100;
+    if ( n < 500 ) {
+      wheel.schedule( 300, periodic );
+    }
+  };
+  wheel.schedule( 300, periodic );
+
+  wheel.advance( 5, count );
+  expect( count == 1, "callback did not get advance()'s arguments, or the cancel did not work" );
+  wheel.advance( 1, count );
+  expect( count == 11, "timer armed by a callback" );
+  wheel.advance( 10000, count );
+  expect( count == 511 and wheel.empty(), "periodic timer" );
+}
+
+// Random schedules and cancels, checked against an ordered map of deadlines
+void random_test()
+{
+  auto rd = get_random_engine();
+  TimerWheel<> wheel;
+  map<uint64_t, uint64_t> expected; // serial -> deadline
+  map<uint64_t, TimerWheel<>::Id> ids;
+  uint64_t serial = 0;
+
+  uniform_int_distribution<uint64_t> delay_dist { 0, 300000 };
+  uniform_int_distribution<uint64_t> step_dist { 0, 2000 };
+  uniform_int_distribution<int> action { 0, 9 };
+
+  for ( int i = 0; i < 20000; ++i ) {
+    const int what = action( rd );
+    if ( what < 5 ) {
+      const uint64_t id = serial++;
+      const uint64_t delay = delay_dist( rd );
+      expected[id] = wheel.now() + max<uint64_t>( delay, 1 );
+      ids[id] = wheel.schedule( delay, [&, id] {
+        expect( expected.count( id ), "cancelled or repeated timer fired" );
+        expect( expected[id] == wheel.now(), "random timer fired at the wrong time" );
+        expected.erase( id );
+        ids.erase( id );
+      } );
+    } else if ( what < 7 and not ids.empty() ) {
+      const auto it = ids.begin();
+      expect( wheel.cancel( it->second ), "cancel() of a pending random timer" );
+      expected.erase( it->first );
+      ids.erase( it );
+    } else {
+      wheel.advance( step_dist( rd ) );
+      for ( const auto& [id, deadline] : expected ) {
+        expect( deadline > wheel.now(), "random timer did not fire" );
+      }
+    }
+    expect( wheel.size() == expected.size(), "size() disagrees with the model" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    deadlines_test();
+    far_deadline_test();
+    cancel_test();
+    callback_test();
+    random_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+#include "arp_message.hh"
+#include "byte_stream.hh"
+#include "ethernet_frame.hh"
+#include "network_interface.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "timer_wheel.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+// What one millisecond of timekeeping costs as the number of connections (or ARP neighbors) grows.
+// Each TCPSender has its SYN outstanding, so its retransmission timer runs and backs off. Ticking every
+// sender every millisecond costs O(connections); arming each sender's next_deadline() on a shared
+// TimerWheel and ticking it only when that fires costs O(expiring timers). Prints CSV.
+
+namespace {
+
+constexpr uint64_t VIRTUAL_TIME_MS = 5000;
+
+struct Connection
+{
+  ByteStream outbound { 1000 };
+  TCPSender sender;
+  uint64_t last_tick_ms { 0 };
+  uint64_t sent { 0 };
+
+  explicit Connection( const TCPConfig& cfg ) : sender( cfg ) {}
+
+  void send_all()
+  {
+    while ( sender.maybe_send() ) {
+      ++sent;
+    }
+  }
+};
+
+deque<Connection> make_connections( size_t count )
+{
+  TCPConfig cfg;
+  cfg.fixed_isn = Wrap32 { 0 };
+  deque<Connection> connections;
+  for ( size_t i = 0; i < count; ++i ) {
+    Connection& c = connections.emplace_back( cfg );
+    c.sender.push( c.outbound.reader() );
+    c.send_all();
+  }
+  return connections;
+}
+
+uint64_t total_sent( const deque<Connection>& connections )
+{
+  uint64_t sent = 0;
+  for ( const auto& c : connections ) {
+    sent += c.sent;
+  }
+  return sent;
+}
+
+void report( const string& driver, size_t count, uint64_t sent, steady_clock::time_point start )
+{
+  const double ns = duration_cast<duration<double, nano>>( steady_clock::now() - start ).count();
+  cout << driver << "," << count << "," << fixed << setprecision( 1 ) << ns / VIRTUAL_TIME_MS << "," << sent
+       << "\n";
+}
+
+// tick every sender every millisecond
+uint64_t scan_test( size_t count )
+{
+  auto connections = make_connections( count );
+  const auto start = steady_clock::now();
+  for ( uint64_t now = 1; now <= VIRTUAL_TIME_MS; ++now ) {
+    for ( auto& c : connections ) {
+      c.sender.tick( 1 );
+      c.send_all();
+    }
+  }
+  const uint64_t sent = total_sent( connections );
+  report( "scan", count, sent, start );
+  return sent;
+}
+
+// tick each sender when its deadline on the wheel fires, then arm the next one
+uint64_t wheel_test( size_t count )
+{
+  auto connections = make_connections( count );
+  TimerWheel<> wheel;
+
+  function<void( Connection& )> arm = [&]( Connection& c ) {
+    if ( const auto deadline = c.sender.next_deadline() ) {
+      wheel.schedule( *deadline, [&] {
+        c.sender.tick( wheel.now() - c.last_tick_ms );
+        c.last_tick_ms = wheel.now();
+        c.send_all();
+        arm( c );
+      } );
+    }
+  };
+
+  const auto start = steady_clock::now();
+  for ( auto& c : connections ) {
+    arm( c );
+  }
+  for ( uint64_t now = 1; now <= VIRTUAL_TIME_MS; ++now ) {
+    wheel.advance( 1 );
+  }
+  const uint64_t sent = total_sent( connections );
+  report( "wheel", count, sent, start );
+  return sent;
+}
+
+// NetworkInterface::tick with `count` learned ARP mappings
+void arp_test( size_t count )
+{
+  const EthernetAddress local_eth { 0x02, 0, 0, 0, 0, 1 };
+  NetworkInterface interface { local_eth, Address( "10.0.0.1", 0 ) };
+  for ( size_t i = 0; i < count; ++i ) {
+    ARPMessage arp;
+    arp.opcode = ARPMessage::OPCODE_REQUEST;
+    arp.sender_ethernet_address = { 0x02, 0, 0, 0, 0, 2 };
+    arp.sender_ip_address = static_cast<uint32_t>( 0x0b000000 + i );
+    arp.target_ip_address = 0x0c000001; // not us: learn the sender, don't reply
+    interface.recv_frame( { { ETHERNET_BROADCAST, arp.sender_ethernet_address, EthernetHeader::TYPE_ARP },
+                            serialize( arp ) } );
+  }
+
+  const auto start = steady_clock::now();
+  for ( uint64_t now = 1; now <= VIRTUAL_TIME_MS; ++now ) {
+    interface.tick( 1 );
+  }
+  report( "arp", count, 0, start );
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    cout << "driver,connections,ns_per_ms,segments_sent\n";
+    for ( const size_t count : { 10UL, 100UL, 1000UL, 10000UL } ) {
+      if ( scan_test( count ) != wheel_test( count ) ) {
+        throw runtime_error( "scan and wheel drivers sent different numbers of segments" );
+      }
+    }
+    for ( const size_t count : { 10UL, 1000UL, 100000UL } ) {
+      arp_test( count );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -2,22 +2,60 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 
+// A reference-counted string. Copies share the same storage, and substr() makes a slice of it
+// without copying the bytes; a slice only gets a private copy if it is modified.
 class Buffer
 {
   std::shared_ptr<std::string> buffer_;
+  size_t offset_ { 0 };
+  size_t length_ { std::string::npos }; // npos: all of *buffer_ (not a slice)
+
+  bool is_slice() const { return length_ != std::string::npos; }
+
+  // Replace a slice with a private copy of its bytes (before it can be modified)
+  void own()
+  {
+    if ( is_slice() ) {
+      buffer_ = std::make_shared<std::string>( std::string_view { *this } );
+      offset_ = 0;
+      length_ = std::string::npos;
+    }
+  }
 
 public:
   // NOLINTBEGIN(*-explicit-*)
 
   Buffer( std::string str = {} ) : buffer_( make_shared<std::string>( std::move( str ) ) ) {}
-  operator std::string_view() const { return *buffer_; }
-  operator std::string&() { return *buffer_; }
+  operator std::string_view() const
+  {
+    return is_slice() ? std::string_view { *buffer_ }.substr( offset_, length_ ) : *buffer_;
+  }
+  operator std::string&()
+  {
+    own();
+    return *buffer_;
+  }
 
   // NOLINTEND(*-explicit-*)
 
-  std::string&& release() { return std::move( *buffer_ ); }
-  size_t size() const { return buffer_->size(); }
-  size_t length() const { return buffer_->length(); }
-  bool empty() const { return buffer_->empty(); }
+  // The bytes [pos, pos + len), sharing this Buffer's storage
+  Buffer substr( size_t pos, size_t len = std::string::npos ) const
+  {
+    Buffer slice { *this };
+    const std::string_view view = std::string_view { *this }.substr( pos, len );
+    slice.offset_ = static_cast<size_t>( view.data() - buffer_->data() );
+    slice.length_ = view.size();
+    return slice;
+  }
+
+  std::string&& release()
+  {
+    own();
+    return std::move( *buffer_ );
+  }
+  size_t size() const { return is_slice() ? length_ : buffer_->size(); }
+  size_t length() const { return size(); }
+  bool empty() const { return size() == 0; }
 };
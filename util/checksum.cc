@@ -0,0 +1,197 @@
+#include "checksum.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#define CHECKSUM_X86
+#endif
+
+using namespace std;
+
+namespace {
+
+// end-around carry: fold a one's-complement sum down to 16 bits
+uint16_t fold( uint64_t sum )
+{
+  while ( sum > 0xffff ) {
+    sum = ( sum >> 16 ) + ( sum & 0xffff );
+  }
+  return static_cast<uint16_t>( sum );
+}
+
+// The wide kernels add the bytes as native-order words. The one's-complement sum of byte-swapped words is the
+// byte-swapped sum (RFC 1071 2(B)), so on a little-endian host their result only needs swapping once.
+uint16_t to_big_endian( uint16_t sum )
+{
+  if constexpr ( endian::native == endian::little ) {
+    return static_cast<uint16_t>( ( sum << 8 ) | ( sum >> 8 ) );
+  }
+  return sum;
+}
+
+// Each kernel sums `data` and, if COPY, copies it to `dst` in the same pass
+
+template<bool COPY>
+uint16_t scalar_sum( string_view data, char* dst )
+{
+  uint64_t sum = 0;
+  for ( size_t i = 0; i < data.size(); ++i ) {
+    const uint8_t byte = data[i];
+    sum += i % 2 ? byte : byte << 8; // 偶数位置是高字节
+  }
+  if constexpr ( COPY ) {
+    memcpy( dst, data.data(), data.size() );
+  }
+  return fold( sum );
+}
+
+// Adds `data` as native-order words to `sum`, 64 bits at a time
+template<bool COPY>
+uint64_t add_words( uint64_t sum, string_view data, char* dst )
+{
+  size_t i = 0;
+  for ( ; i + 8 <= data.size(); i += 8 ) {
+    uint64_t word {};
+    memcpy( &word, data.data() + i, 8 );
+    if constexpr ( COPY ) {
+      memcpy( dst + i, &word, 8 );
+    }
+    sum += word;
+    sum += sum < word; // 进位加回来
+  }
+  if constexpr ( COPY ) {
+    memcpy( dst + i, data.data() + i, data.size() - i );
+  }
+  uint64_t tail = 0;
+  for ( ; i + 2 <= data.size(); i += 2 ) {
+    uint16_t word {};
+    memcpy( &word, data.data() + i, 2 );
+    tail += word;
+  }
+  if ( i < data.size() ) { // an odd last byte, at the start of a word
+    uint16_t word = 0;
+    memcpy( &word, data.data() + i, 1 );
+    tail += word;
+  }
+  sum += tail;
+  return sum + ( sum < tail );
+}
+
+template<bool COPY>
+uint16_t word_sum( string_view data, char* dst )
+{
+  return to_big_endian( fold( add_words<COPY>( 0, data, dst ) ) );
+}
+
+#ifdef CHECKSUM_X86
+// Each 32-bit lane of the vector kernels gains at most 2 * 0xffff per block, so it can take this many blocks
+// before it has to be added up
+constexpr size_t BLOCKS_PER_FLUSH = 32767;
+
+template<bool COPY>
+__attribute__( ( target( "sse2" ) ) ) uint16_t sse2_sum( string_view data, char* dst )
+{
+  const __m128i low_halves = _mm_set1_epi32( 0xffff );
+  uint64_t sum = 0;
+  size_t i = 0;
+  while ( data.size() - i >= 16 ) {
+    const size_t end = i + min( ( data.size() - i ) / 16, BLOCKS_PER_FLUSH ) * 16;
+    __m128i lanes = _mm_setzero_si128();
+    for ( ; i < end; i += 16 ) {
+      const __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data.data() + i ) );
+      if constexpr ( COPY ) {
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), block );
+      }
+      lanes
+        = _mm_add_epi32( lanes, _mm_add_epi32( _mm_and_si128( block, low_halves ), _mm_srli_epi32( block, 16 ) ) );
+    }
+    alignas( 16 ) uint32_t lane[4];
+    _mm_store_si128( reinterpret_cast<__m128i*>( lane ), lanes );
+    sum += uint64_t { lane[0] } + lane[1] + lane[2] + lane[3];
+  }
+  return to_big_endian( fold( add_words<COPY>( sum, data.substr( i ), COPY ? dst + i : dst ) ) );
+}
+
+template<bool COPY>
+__attribute__( ( target( "avx2" ) ) ) uint16_t avx2_sum( string_view data, char* dst )
+{
+  const __m256i low_halves = _mm256_set1_epi32( 0xffff );
+  uint64_t sum = 0;
+  size_t i = 0;
+  while ( data.size() - i >= 32 ) {
+    const size_t end = i + min( ( data.size() - i ) / 32, BLOCKS_PER_FLUSH ) * 32;
+    __m256i lanes = _mm256_setzero_si256();
+    for ( ; i < end; i += 32 ) {
+      const __m256i block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data.data() + i ) );
+      if constexpr ( COPY ) {
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), block );
+      }
+      lanes = _mm256_add_epi32(
+        lanes, _mm256_add_epi32( _mm256_and_si256( block, low_halves ), _mm256_srli_epi32( block, 16 ) ) );
+    }
+    alignas( 32 ) uint32_t lane[8];
+    _mm256_store_si256( reinterpret_cast<__m256i*>( lane ), lanes );
+    for ( const uint32_t x : lane ) {
+      sum += x;
+    }
+  }
+  return to_big_endian( fold( add_words<COPY>( sum, data.substr( i ), COPY ? dst + i : dst ) ) );
+}
+#endif
+
+template<bool COPY>
+uint16_t dispatch( string_view data, char* dst, InternetChecksum::Kernel kernel )
+{
+  switch ( kernel ) {
+    case InternetChecksum::Kernel::Scalar:
+      return scalar_sum<COPY>( data, dst );
+#ifdef CHECKSUM_X86
+    case InternetChecksum::Kernel::SSE2:
+      return sse2_sum<COPY>( data, dst );
+    case InternetChecksum::Kernel::AVX2:
+      return avx2_sum<COPY>( data, dst );
+#endif
+    default:
+      return word_sum<COPY>( data, dst );
+  }
+}
+
+} // namespace
+
+bool InternetChecksum::supported( Kernel kernel )
+{
+  switch ( kernel ) {
+    case Kernel::Scalar:
+    case Kernel::Word:
+      return true;
+#ifdef CHECKSUM_X86
+    case Kernel::SSE2:
+      return __builtin_cpu_supports( "sse2" );
+    case Kernel::AVX2:
+      return __builtin_cpu_supports( "avx2" );
+#endif
+    default:
+      return false;
+  }
+}
+
+InternetChecksum::Kernel InternetChecksum::fastest()
+{
+  static const Kernel kernel = supported( Kernel::AVX2 )   ? Kernel::AVX2
+                               : supported( Kernel::SSE2 ) ? Kernel::SSE2
+                                                           : Kernel::Word;
+  return kernel;
+}
+
+uint16_t InternetChecksum::partial_sum( string_view data, Kernel kernel )
+{
+  return dispatch<false>( data, nullptr, kernel );
+}
+
+uint16_t InternetChecksum::copy_and_sum( char* dst, string_view data, Kernel kernel )
+{
+  return dispatch<true>( data, dst, kernel );
+}
@@ -3,41 +3,93 @@
 #include "buffer.hh"
 
 #include <cstdint>
-#include <string>
+#include <string_view>
 #include <vector>
 
-//! The internet checksum algorithm
+//! The internet checksum algorithm (RFC 1071)
 class InternetChecksum
 {
+public:
+  //! How the bytes are summed: one at a time (the reference), 64 bits at a time with end-around carry, or
+  //! with SSE2 or AVX2 vectors (x86 only, where the CPU has them). All give the same sum.
+  enum class Kernel : uint8_t
+  {
+    Scalar,
+    Word,
+    SSE2,
+    AVX2
+  };
+
+  static bool supported( Kernel kernel );
+  static Kernel fastest(); //!< The fastest supported kernel, chosen once at runtime
+
+  //! The one's-complement sum of `data` as big-endian 16-bit words (an odd last byte is the high half of
+  //! a word), folded to 16 bits but not complemented
+  static uint16_t partial_sum( std::string_view data, Kernel kernel );
+
+  //! The same sum, while copying `data` to `dst`: the bytes are read once for both
+  static uint16_t copy_and_sum( char* dst, std::string_view data, Kernel kernel );
+
+  //! The checksum of data in which one 16-bit word changed from `old_word` to `new_word`, updated from the
+  //! old `checksum` without summing the rest again (RFC 1624 eqn. 3). For header rewrites such as a TTL
+  //! decrement, NAT or ECN marking.
+  static uint16_t update( uint16_t checksum, uint16_t old_word, uint16_t new_word )
+  {
+    uint32_t sum = static_cast<uint16_t>( ~checksum ) + static_cast<uint16_t>( ~old_word ) + uint32_t { new_word };
+    sum = ( sum >> 16 ) + static_cast<uint16_t>( sum );
+    sum = ( sum >> 16 ) + static_cast<uint16_t>( sum );
+    return ~static_cast<uint16_t>( sum );
+  }
+
 private:
-  uint32_t sum_;
-  bool parity_ {};
+  uint64_t sum_;
+  bool parity_ {}; // an odd number of bytes was added: the next one is the low half of a word
+  Kernel kernel_;
 
-public:
-  explicit InternetChecksum( const uint32_t sum = 0 ) : sum_( sum ) {}
-  void add( std::string_view data )
+  void add_bytes( std::string_view data, char* dst ) // copied to `dst` too, unless it is null
   {
-    for ( const uint8_t i : data ) {
-      uint16_t val = i;
-      if ( not parity_ ) {
-        val <<= 8;
+    if ( data.empty() ) {
+      return;
+    }
+    if ( parity_ ) { // 补上一个字的低字节
+      sum_ += static_cast<uint8_t>( data.front() );
+      if ( dst ) {
+        *dst++ = data.front();
       }
-      sum_ += val;
-      parity_ = !parity_;
+      data.remove_prefix( 1 );
+      parity_ = false;
     }
+    sum_ += dst ? copy_and_sum( dst, data, kernel_ ) : partial_sum( data, kernel_ );
+    parity_ = data.size() % 2;
   }
 
-  uint16_t value() const
+public:
+  explicit InternetChecksum( const uint32_t sum = 0, Kernel kernel = fastest() ) : sum_( sum ), kernel_( kernel )
+  {}
+
+  //! Bytes can be added in pieces of any length, odd ones included
+  void add( std::string_view data ) { add_bytes( data, nullptr ); }
+
+  //! Add `data` while copying it to `dst` (e.g. a payload into the segment being built), in one pass
+  void copy_and_add( char* dst, std::string_view data ) { add_bytes( data, dst ); }
+
+  //! Add the partial_sum() of bytes that come next, and are the last ones (or an even number of them)
+  void add_sum( uint16_t sum ) { sum_ += parity_ ? static_cast<uint16_t>( sum << 8 | sum >> 8 ) : sum; }
+
+  //! The one's-complement sum so far, folded to 16 bits (value() is its complement)
+  uint16_t sum() const
   {
-    uint32_t ret = sum_;
+    uint64_t ret = sum_;
 
     while ( ret > 0xffff ) {
       ret = ( ret >> 16 ) + static_cast<uint16_t>( ret );
     }
 
-    return ~ret;
+    return static_cast<uint16_t>( ret );
   }
 
+  uint16_t value() const { return ~sum(); }
+
   void add( const std::vector<Buffer>& data )
   {
     for ( const auto& x : data ) {
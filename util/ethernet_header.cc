@@ -1,10 +1,21 @@
 #include "ethernet_header.hh"
+#include "header_layout.hh"
 
 #include <iomanip>
 #include <sstream>
 
 using namespace std;
 
+namespace {
+
+using Layout = HeaderLayout<HeaderField<&EthernetHeader::dst, 0, 48>,
+                            HeaderField<&EthernetHeader::src, 48, 48>,
+                            HeaderField<&EthernetHeader::type, 96, 16>>; // e.g. IPv4, ARP, or something else
+
+static_assert( Layout::LENGTH == EthernetHeader::LENGTH );
+
+} // namespace
+
 //! \returns A string with a textual representation of an Ethernet address
 string to_string( const EthernetAddress address )
 {
@@ -43,32 +54,10 @@ string EthernetHeader::to_string() const
 
 void EthernetHeader::parse( Parser& parser )
 {
-  // read destination address
-  for ( auto& b : dst ) {
-    parser.integer( b );
-  }
-
-  // read source address
-  for ( auto& b : src ) {
-    parser.integer( b );
-  }
-
-  // read frame type (e.g. IPv4, ARP, or something else)
-  parser.integer( type );
+  Layout::parse( *this, parser );
 }
 
 void EthernetHeader::serialize( Serializer& serializer ) const
 {
-  // write destination address
-  for ( const auto& b : dst ) {
-    serializer.integer( b );
-  }
-
-  // write source address
-  for ( const auto& b : src ) {
-    serializer.integer( b );
-  }
-
-  // write frame type (e.g. IPv4, ARP, or something else)
-  serializer.integer( type );
+  Layout::serialize( *this, serializer );
 }
@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <fcntl.h>
+#include <climits>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -167,10 +169,12 @@ size_t FileDescriptor::write( const vector<Buffer>& buffers )
 
 size_t FileDescriptor::write( const vector<string_view>& buffers )
 {
+  // writev(2) rejects more than IOV_MAX regions; write the first IOV_MAX and report a short write
+  const size_t count = min( buffers.size(), static_cast<size_t>( IOV_MAX ) );
   vector<iovec> iovecs;
-  iovecs.reserve( buffers.size() );
+  iovecs.reserve( count );
   size_t total_size = 0;
-  for ( const auto x : buffers ) {
+  for ( const auto x : span( buffers ).first( count ) ) {
     iovecs.push_back( { const_cast<char*>( x.data() ), x.size() } ); // NOLINT(*-const-cast)
     total_size += x.size();
   }
@@ -66,7 +66,7 @@ public:
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
 
-  // Attempt to write a buffer
+  // Attempt to write a buffer (or a list of buffers, with one writev)
   // returns number of bytes written
   size_t write( std::string_view buffer );
   size_t write( const std::vector<std::string_view>& buffers );
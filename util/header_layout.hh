@@ -0,0 +1,153 @@
+#pragma once
+
+#include "parser.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+// A header whose fields sit at fixed bit offsets, described as a list of fields, each `BITS` bits wide and
+// starting `OFFSET` bits into the header (counted from the most significant bit of the first byte, as in
+// the RFC diagrams). For example, the start of the IPv4 header is
+//
+//   HeaderLayout<HeaderField<&IPv4Header::ver, 0, 4>,
+//                HeaderField<&IPv4Header::hlen, 4, 4>,
+//                HeaderField<&IPv4Header::tos, 8, 8>, ...>
+//
+// The layout checks at compile time that the fields follow one another and fill whole bytes. Parsing reads
+// the whole header with one bounds check, then decodes each field with constant shifts and masks; serializing
+// does the reverse into a zeroed array, and appends it to the Serializer in one go.
+
+// Loads and stores bits [OFFSET, OFFSET + BITS) of a big-endian header
+template<size_t OFFSET, size_t BITS>
+struct HeaderBits
+{
+  static_assert( BITS > 0 and BITS <= 64 );
+
+  static constexpr size_t offset = OFFSET;
+  static constexpr size_t bits = BITS;
+
+private:
+  static constexpr size_t FIRST = OFFSET / 8;
+  static constexpr size_t COUNT = ( OFFSET + BITS - 1 ) / 8 - FIRST + 1; // bytes the field touches
+  static constexpr size_t SHIFT = COUNT * 8 - OFFSET % 8 - BITS;         // bits after it in its last byte
+  static constexpr uint64_t MASK = BITS == 64 ? UINT64_MAX : ( uint64_t { 1 } << BITS ) - 1;
+  static_assert( COUNT <= 8, "a field may touch at most 8 bytes" );
+
+public:
+  static uint64_t load( const char* header )
+  {
+    uint64_t word = 0;
+    for ( size_t i = 0; i < COUNT; ++i ) {
+      word = word << 8 | static_cast<uint8_t>( header[FIRST + i] );
+    }
+    return word >> SHIFT & MASK;
+  }
+
+  // `header` must start zeroed: the field is OR-ed in, so neighbouring fields can share a byte
+  static void store( char* header, uint64_t value )
+  {
+    const uint64_t word = ( value & MASK ) << SHIFT;
+    for ( size_t i = 0; i < COUNT; ++i ) {
+      header[FIRST + i] = static_cast<char>( header[FIRST + i] | ( word >> ( COUNT - 1 - i ) * 8 & 0xff ) );
+    }
+  }
+};
+
+// A field stored in the member `MEMBER` of the header's struct: an unsigned integer, a bool (a flag), or an
+// array of bytes (such as an EthernetAddress), which must be byte-aligned and exactly fill its bits
+template<auto MEMBER, size_t OFFSET, size_t BITS>
+struct HeaderField : HeaderBits<OFFSET, BITS>
+{
+  template<class Header>
+  static void read( Header& header, const char* bytes )
+  {
+    using T = std::remove_reference_t<decltype( header.*MEMBER )>;
+    if constexpr ( std::is_same_v<T, std::array<uint8_t, sizeof( T )>> ) {
+      static_assert( OFFSET % 8 == 0 and BITS == sizeof( T ) * 8 );
+      std::memcpy( ( header.*MEMBER ).data(), bytes + OFFSET / 8, sizeof( T ) );
+    } else if constexpr ( std::is_same_v<T, bool> ) {
+      header.*MEMBER = HeaderBits<OFFSET, BITS>::load( bytes ) != 0;
+    } else {
+      static_assert( std::is_unsigned_v<T> and BITS <= sizeof( T ) * 8 );
+      header.*MEMBER = static_cast<T>( HeaderBits<OFFSET, BITS>::load( bytes ) );
+    }
+  }
+
+  template<class Header>
+  static void write( const Header& header, char* bytes )
+  {
+    using T = std::remove_cvref_t<decltype( header.*MEMBER )>;
+    if constexpr ( std::is_same_v<T, std::array<uint8_t, sizeof( T )>> ) {
+      static_assert( OFFSET % 8 == 0 and BITS == sizeof( T ) * 8 );
+      std::memcpy( bytes + OFFSET / 8, ( header.*MEMBER ).data(), sizeof( T ) );
+    } else {
+      HeaderBits<OFFSET, BITS>::store( bytes, static_cast<uint64_t>( header.*MEMBER ) );
+    }
+  }
+};
+
+// Bits the header's struct doesn't keep: ignored when parsing, and sent as zero
+template<size_t OFFSET, size_t BITS>
+struct HeaderReserved : HeaderBits<OFFSET, BITS>
+{
+  template<class Header>
+  static void read( Header& /* header */, const char* /* bytes */ )
+  {}
+
+  template<class Header>
+  static void write( const Header& /* header */, char* /* bytes */ )
+  {}
+};
+
+template<class... Fields>
+class HeaderLayout
+{
+  static constexpr bool contiguous()
+  {
+    size_t next = 0;
+    bool ok = true;
+    ( ( ok = ok and Fields::offset == next, next += Fields::bits ), ... );
+    return ok and next % 8 == 0;
+  }
+  static_assert( contiguous(), "fields must follow one another, without gaps or overlaps, and fill whole bytes" );
+
+public:
+  static constexpr size_t LENGTH = ( Fields::bits + ... ) / 8; // bytes
+
+  using Bytes = std::array<char, LENGTH>;
+
+  template<class Header>
+  static void from_bytes( Header& header, const Bytes& bytes )
+  {
+    ( Fields::read( header, bytes.data() ), ... );
+  }
+
+  template<class Header>
+  static Bytes to_bytes( const Header& header )
+  {
+    Bytes bytes {};
+    ( Fields::write( header, bytes.data() ), ... );
+    return bytes;
+  }
+
+  template<class Header>
+  static void parse( Header& header, Parser& parser )
+  {
+    Bytes bytes {};
+    parser.string( bytes );
+    if ( not parser.has_error() ) {
+      from_bytes( header, bytes );
+    }
+  }
+
+  template<class Header>
+  static void serialize( const Header& header, Serializer& serializer )
+  {
+    const Bytes bytes = to_bytes( header );
+    serializer.string( { bytes.data(), bytes.size() } );
+  }
+};
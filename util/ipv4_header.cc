@@ -1,5 +1,6 @@
 #include "ipv4_header.hh"
 #include "checksum.hh"
+#include "header_layout.hh"
 
 #include <arpa/inet.h>
 #include <array>
@@ -8,28 +9,31 @@
 
 using namespace std;
 
+namespace {
+
+using Layout = HeaderLayout<HeaderField<&IPv4Header::ver, 0, 4>,
+                            HeaderField<&IPv4Header::hlen, 4, 4>,
+                            HeaderField<&IPv4Header::tos, 8, 8>,
+                            HeaderField<&IPv4Header::len, 16, 16>,
+                            HeaderField<&IPv4Header::id, 32, 16>,
+                            HeaderReserved<48, 1>,
+                            HeaderField<&IPv4Header::df, 49, 1>, // don't fragment
+                            HeaderField<&IPv4Header::mf, 50, 1>, // more fragments
+                            HeaderField<&IPv4Header::offset, 51, 13>,
+                            HeaderField<&IPv4Header::ttl, 64, 8>,
+                            HeaderField<&IPv4Header::proto, 72, 8>,
+                            HeaderField<&IPv4Header::cksum, 80, 16>,
+                            HeaderField<&IPv4Header::src, 96, 32>,
+                            HeaderField<&IPv4Header::dst, 128, 32>>;
+
+static_assert( Layout::LENGTH == IPv4Header::LENGTH );
+
+} // namespace
+
 // Parse from string.
 void IPv4Header::parse( Parser& parser )
 {
-  uint8_t first_byte {};
-  parser.integer( first_byte );
-  ver = first_byte >> 4;    // version
-  hlen = first_byte & 0x0f; // header length
-  parser.integer( tos );    // type of service
-  parser.integer( len );
-  parser.integer( id );
-
-  uint16_t fo_val {};
-  parser.integer( fo_val );
-  df = static_cast<bool>( fo_val & 0x4000 ); // don't fragment
-  mf = static_cast<bool>( fo_val & 0x2000 ); // more fragments
-  offset = fo_val & 0x1fff;                  // offset
-
-  parser.integer( ttl );
-  parser.integer( proto );
-  parser.integer( cksum );
-  parser.integer( src );
-  parser.integer( dst );
+  Layout::parse( *this, parser );
 
   if ( ver != 4 ) {
     parser.set_error();
@@ -61,22 +65,7 @@ void IPv4Header::serialize( Serializer& serializer ) const
     throw runtime_error( "wrong IP version" );
   }
 
-  const uint8_t first_byte = ( static_cast<uint32_t>( ver ) << 4 ) | ( hlen & 0xfU );
-  serializer.integer( first_byte ); // version and header length
-  serializer.integer( tos );
-  serializer.integer( len );
-  serializer.integer( id );
-
-  const uint16_t fo_val = ( df ? 0x4000U : 0 ) | ( mf ? 0x2000U : 0 ) | ( offset & 0x1fffU );
-  serializer.integer( fo_val );
-
-  serializer.integer( ttl );
-  serializer.integer( proto );
-
-  serializer.integer( cksum );
-
-  serializer.integer( src );
-  serializer.integer( dst );
+  Layout::serialize( *this, serializer );
 }
 
 uint16_t IPv4Header::payload_length() const
@@ -107,15 +96,21 @@ uint32_t IPv4Header::pseudo_checksum() const
 void IPv4Header::compute_checksum()
 {
   cksum = 0;
-  Serializer s;
-  serialize( s );
+  const auto bytes = Layout::to_bytes( *this );
 
   // calculate checksum -- taken over header only
   InternetChecksum check;
-  check.add( s.output() );
+  check.add( { bytes.data(), bytes.size() } );
   cksum = check.value();
 }
 
+void IPv4Header::decrement_ttl()
+{
+  const uint16_t old_word = static_cast<uint16_t>( ttl << 8 | proto ); // TTL 和协议共用一个 16 位字
+  --ttl;
+  cksum = InternetChecksum::update( cksum, old_word, static_cast<uint16_t>( ttl << 8 | proto ) );
+}
+
 std::string IPv4Header::to_string() const
 {
   stringstream ss {};
@@ -57,6 +57,9 @@ struct IPv4Header
   // Set checksum to correct value
   void compute_checksum();
 
+  // Decrement the TTL, patching the checksum for the one changed word instead of computing it again
+  void decrement_ttl();
+
   // Return a string containing a header in human-readable format
   std::string to_string() const;
 
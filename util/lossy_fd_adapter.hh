@@ -5,7 +5,9 @@
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 
+#include <algorithm>
 #include <optional>
+#include <queue>
 #include <random>
 #include <utility>
 
@@ -20,6 +22,30 @@ private:
   //! The underlying FD adapter
   AdapterT _adapter;
 
+  //! Segments waiting in the uplink bottleneck, and the bytes it may forward before the next tick
+  std::queue<TCPSegment> _bottleneck {};
+  double _bottleneck_credit {};
+  uint64_t _bottleneck_drops {};
+
+  //! The largest segment written so far (the MSS is configurable), which an idle bottleneck may save up for
+  double _full_wire_size { static_cast<double>( TCPConfig::MAX_PAYLOAD_SIZE + 40 ) };
+
+  //! Bytes a segment occupies on the bottleneck link (payload plus IPv4 and TCP headers)
+  static double _wire_size( const TCPSegment& seg )
+  {
+    return static_cast<double>( seg.sender_message.payload.size() + 40 );
+  }
+
+  //! Forward as many queued segments as the bottleneck's credit allows
+  void _drain_bottleneck()
+  {
+    while ( not _bottleneck.empty() and _bottleneck_credit >= _wire_size( _bottleneck.front() ) ) {
+      _bottleneck_credit -= _wire_size( _bottleneck.front() );
+      _adapter.write( _bottleneck.front() );
+      _bottleneck.pop();
+    }
+  }
+
   //! \brief Determine whether or not to drop a given read or write
   //! \param[in] uplink is `true` to use the uplink loss probability, else use the downlink loss probability
   //! \returns `true` if the segment should be dropped
@@ -51,19 +77,42 @@ public:
 
   //! \brief Write to the underlying AdapterT instance, potentially dropping the datagram to be written
   //! \param[in] seg is the packet to either write or drop
+  //! \details With a bottleneck_rate, the segment first waits in a drop-tail queue of bottleneck_queue
+  //!          segments that tick() drains at that rate, like a shallow router buffer in front of a slow link
   void write( TCPSegment& seg )
   {
     if ( _should_drop( true ) ) {
       return;
     }
-    return _adapter.write( seg );
+    if ( config().bottleneck_rate == 0 ) {
+      return _adapter.write( seg );
+    }
+    if ( _bottleneck.size() >= config().bottleneck_queue ) {
+      ++_bottleneck_drops;
+      return;
+    }
+    _full_wire_size = std::max( _full_wire_size, _wire_size( seg ) );
+    _bottleneck.push( seg );
+    _drain_bottleneck();
   }
 
+  //! Segments the bottleneck dropped because its queue was full
+  uint64_t bottleneck_drops() const { return _bottleneck_drops; }
+
   //! \name
   //! Passthrough functions to the underlying AdapterT instance
 
   void set_listening( const bool l ) { _adapter.set_listening( l ); } //!< FdAdapterBase::set_listening passthrough
   const FdAdapterConfig& config() const { return _adapter.config(); } //!< FdAdapterBase::config passthrough
   FdAdapterConfig& config_mut() { return _adapter.config_mut(); }     //!< FdAdapterBase::config_mut passthrough
-  void tick( const size_t ms_since_last_tick ) { _adapter.tick( ms_since_last_tick ); }
+  void tick( const size_t ms_since_last_tick )
+  {
+    if ( config().bottleneck_rate != 0 ) {
+      // an idle link saves up no more than one full-sized segment
+      const double added = static_cast<double>( config().bottleneck_rate * ms_since_last_tick ) / 1000;
+      _bottleneck_credit = std::min( _bottleneck_credit + added, std::max( added, _full_wire_size ) );
+      _drain_bottleneck();
+    }
+    _adapter.tick( ms_since_last_tick );
+  }
 };
@@ -3,6 +3,7 @@
 #include "buffer.hh"
 
 #include <algorithm>
+#include <bit>
 #include <concepts>
 #include <cstdint>
 #include <cstring>
@@ -65,11 +66,7 @@ class Parser
       if ( empty() ) {
         return;
       }
-      std::string first_str = std::move( buffer_.front() );
-      if ( skip_ ) {
-        first_str = first_str.substr( skip_ );
-      }
-      out.emplace_back( std::move( first_str ) );
+      out.push_back( skip_ ? buffer_.front().substr( skip_ ) : buffer_.front() );
       buffer_.pop_front();
       for ( auto&& x : buffer_ ) {
         out.emplace_back( std::move( x ) );
@@ -93,6 +90,9 @@ class Parser
 
     void append( Buffer str )
     {
+      if ( str.empty() ) { // so the front Buffer always has bytes left
+        return;
+      }
       size_ += str.size();
       buffer_.push_back( std::move( str ) );
     }
@@ -101,6 +101,18 @@ class Parser
   BufferList input_;
   bool error_ {};
 
+  template<std::unsigned_integral T>
+  static T byteswap( T val ) // std::byteswap is C++23
+  {
+    if constexpr ( sizeof( T ) == 2 ) {
+      return __builtin_bswap16( val );
+    } else if constexpr ( sizeof( T ) == 4 ) {
+      return __builtin_bswap32( val );
+    } else {
+      return __builtin_bswap64( val );
+    }
+  }
+
   void check_size( const size_t size )
   {
     if ( size > input_.size() ) {
@@ -125,17 +137,23 @@ public:
       return;
     }
 
-    if constexpr ( sizeof( T ) == 1 ) {
-      out = static_cast<uint8_t>( input_.peek().front() );
-      input_.remove_prefix( 1 );
-      return;
-    } else {
-      out = static_cast<T>( 0 );
-      for ( size_t i = 0; i < sizeof( T ); i++ ) {
-        out <<= 8;
-        out |= static_cast<uint8_t>( input_.peek().front() );
-        input_.remove_prefix( 1 );
+    // Fast path: the integer lies within the front Buffer, so it is one (unaligned, big-endian) load
+    const std::string_view front = input_.peek();
+    if ( front.size() >= sizeof( T ) ) {
+      std::memcpy( &out, front.data(), sizeof( T ) );
+      if constexpr ( std::endian::native == std::endian::little and sizeof( T ) > 1 ) {
+        out = byteswap( out );
       }
+      input_.remove_prefix( sizeof( T ) );
+      return;
+    }
+
+    // 跨越 Buffer 边界：逐字节读取
+    out = static_cast<T>( 0 );
+    for ( size_t i = 0; i < sizeof( T ); i++ ) {
+      out <<= 8;
+      out |= static_cast<uint8_t>( input_.peek().front() );
+      input_.remove_prefix( 1 );
     }
   }
 
@@ -178,6 +196,8 @@ public:
     }
   }
 
+  void string( std::string_view str ) { buffer_.append( str ); }
+
   void buffer( const Buffer& buf )
   {
     flush();
@@ -0,0 +1,222 @@
+#include "spsc_byte_stream.hh"
+
+#include "exception.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+EventFD::EventFD()
+  : FileDescriptor( ::CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+{}
+
+// With the stream indices also stored/loaded seq_cst, either clear() comes first and the waiter's
+// re-check sees the update that preceded signal(), or signal() sees pending_ == false and writes the fd.
+void EventFD::signal()
+{
+  if ( pending_.exchange( true ) ) {
+    return; // already readable, and the waiter hasn't cleared it yet
+  }
+  const uint64_t one = 1;
+  CheckSystemCall( "write", ::write( fd_num(), &one, sizeof( one ) ) );
+  register_write();
+}
+
+void EventFD::clear()
+{
+  // Reset the fd before pending_: the other order lets a signal() land in between and leave
+  // pending_ set with nothing readable, losing every later wakeup.
+  uint64_t count {};
+  const auto ret = ::read( fd_num(), &count, sizeof( count ) );
+  if ( ret < 0 and errno != EAGAIN ) { // EAGAIN: nothing was signaled, so there is nothing to reset
+    throw unix_error { "read" };
+  }
+  register_read(); // lets EventLoop see that the rule serviced its fd
+  pending_.store( false );
+}
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity, bool with_events ) : capacity_( capacity ), ring_( capacity, '\0' )
+{
+  if ( with_events ) {
+    readable_.emplace();
+    writable_.emplace();
+  }
+}
+
+FileDescriptor& SPSCByteStream::readable_event()
+{
+  if ( not readable_.has_value() ) {
+    throw runtime_error( "SPSCByteStream constructed without events" );
+  }
+  return readable_.value();
+}
+
+FileDescriptor& SPSCByteStream::writable_event()
+{
+  if ( not writable_.has_value() ) {
+    throw runtime_error( "SPSCByteStream constructed without events" );
+  }
+  return writable_.value();
+}
+
+uint64_t SPSCWriter::push( string_view data )
+{
+  if ( error_.load( memory_order_relaxed ) or is_closed() ) {
+    return 0;
+  }
+
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return 0;
+  }
+
+  const uint64_t pushed = pushed_len_.load( memory_order_relaxed );
+  const uint64_t tail = pushed % capacity_;
+  const uint64_t first_part = min( len, capacity_ - tail );
+  copy_n( data.data(), first_part, ring_.data() + tail );
+  copy_n( data.data() + first_part, len - first_part, ring_.data() );
+
+  // publish the bytes to the reader
+  pushed_len_.store( pushed + len );
+
+  if ( readable_.has_value() ) {
+    readable_->signal();
+  }
+  return len;
+}
+
+void SPSCWriter::close()
+{
+  closed_.store( true );
+  if ( readable_.has_value() ) {
+    readable_->signal();
+  }
+}
+
+void SPSCWriter::set_error()
+{
+  error_.store( true );
+  if ( readable_.has_value() ) {
+    readable_->signal();
+  }
+}
+
+bool SPSCWriter::is_closed() const
+{
+  return closed_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCWriter::available_capacity() const
+{
+  return capacity_ - pushed_len_.load( memory_order_relaxed ) + popped_len_.load();
+}
+
+uint64_t SPSCWriter::bytes_pushed() const
+{
+  return pushed_len_.load( memory_order_relaxed );
+}
+
+void SPSCWriter::ack_writable_event()
+{
+  if ( writable_.has_value() ) {
+    writable_->clear();
+  }
+}
+
+string_view SPSCReader::peek() const
+{
+  const uint64_t buffered = bytes_buffered();
+  if ( buffered == 0 ) {
+    return {};
+  }
+  const uint64_t head = popped_len_.load( memory_order_relaxed ) % capacity_;
+  return string_view { ring_ }.substr( head, min( buffered, capacity_ - head ) );
+}
+
+vector<string_view> SPSCReader::peek_iov() const
+{
+  const uint64_t buffered = bytes_buffered();
+  vector<string_view> regions;
+  if ( buffered == 0 ) {
+    return regions;
+  }
+  const uint64_t head = popped_len_.load( memory_order_relaxed ) % capacity_;
+  regions.push_back( string_view { ring_ }.substr( head, min( buffered, capacity_ - head ) ) );
+  if ( regions.front().size() < buffered ) {
+    regions.emplace_back( ring_.data(), buffered - regions.front().size() );
+  }
+  return regions;
+}
+
+void SPSCReader::pop( uint64_t len )
+{
+  len = min( len, bytes_buffered() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  // hand the space back to the writer
+  popped_len_.store( popped_len_.load( memory_order_relaxed ) + len );
+
+  if ( writable_.has_value() ) {
+    writable_->signal();
+  }
+}
+
+bool SPSCReader::is_finished() const
+{
+  // closed_ is stored after the final push, so reading it first makes the emptiness check conclusive
+  return closed_.load() and bytes_buffered() == 0;
+}
+
+bool SPSCReader::has_error() const
+{
+  return error_.load();
+}
+
+uint64_t SPSCReader::bytes_buffered() const
+{
+  return pushed_len_.load() - popped_len_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCReader::bytes_popped() const
+{
+  return popped_len_.load( memory_order_relaxed );
+}
+
+void SPSCReader::ack_readable_event()
+{
+  if ( readable_.has_value() ) {
+    readable_->clear();
+  }
+}
+
+SPSCReader& SPSCByteStream::reader()
+{
+  static_assert( sizeof( SPSCReader ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCReader." );
+
+  return static_cast<SPSCReader&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCReader& SPSCByteStream::reader() const
+{
+  return static_cast<const SPSCReader&>( *this ); // NOLINT(*-downcast)
+}
+
+SPSCWriter& SPSCByteStream::writer()
+{
+  static_assert( sizeof( SPSCWriter ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCWriter." );
+
+  return static_cast<SPSCWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCWriter& SPSCByteStream::writer() const
+{
+  return static_cast<const SPSCWriter&>( *this ); // NOLINT(*-downcast)
+}
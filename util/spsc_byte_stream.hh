@@ -0,0 +1,100 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A Linux eventfd used as a level-triggered wakeup: readable once signal() has been called
+// since the last clear(). Redundant signals are coalesced and cost no system call.
+class EventFD : public FileDescriptor
+{
+  std::atomic<bool> pending_ { false };
+
+public:
+  EventFD();
+
+  void signal(); // Make the fd readable (if it isn't already)
+  void clear();  // Consume the wakeup; call *before* re-checking the condition that was waited on
+};
+
+class SPSCReader;
+class SPSCWriter;
+
+// A ByteStream whose Writer and Reader may be used from two different threads
+// (one producer, one consumer) without locks: the bytes live in a ring of
+// `capacity` bytes, and each side owns one atomic index into it.
+//
+// Optionally, each side can be woken by an eventfd that plugs into EventLoop::add_rule
+// (Direction::In): readable_event() after the writer pushes, closes or sets an error, and
+// writable_event() after the reader pops. The woken side calls ack_*_event() before retrying.
+class SPSCByteStream
+{
+protected:
+  static constexpr size_t kCacheLine = 64;
+
+  uint64_t capacity_;
+  std::string ring_;
+  // Each index is written only by its own side; the other side's index is always read seq_cst.
+  alignas( kCacheLine ) std::atomic<uint64_t> pushed_len_ { 0 }; // written only by the Writer
+  alignas( kCacheLine ) std::atomic<uint64_t> popped_len_ { 0 }; // written only by the Reader
+  std::atomic<bool> closed_ { false };
+  std::atomic<bool> error_ { false };
+  std::optional<EventFD> readable_ {};
+  std::optional<EventFD> writable_ {};
+
+public:
+  explicit SPSCByteStream( uint64_t capacity, bool with_events = false );
+
+  SPSCReader& reader();
+  const SPSCReader& reader() const;
+  SPSCWriter& writer();
+  const SPSCWriter& writer() const;
+
+  // Wakeup fds (only if constructed `with_events`)
+  FileDescriptor& readable_event();
+  FileDescriptor& writable_event();
+
+  SPSCByteStream( const SPSCByteStream& other ) = delete;
+  SPSCByteStream& operator=( const SPSCByteStream& other ) = delete;
+  SPSCByteStream( SPSCByteStream&& other ) = delete;
+  SPSCByteStream& operator=( SPSCByteStream&& other ) = delete;
+  ~SPSCByteStream() = default;
+};
+
+// Producer side: call only from the producer thread
+class SPSCWriter : public SPSCByteStream
+{
+public:
+  uint64_t push( std::string_view data ); // Push as much of data as fits, returns the number of bytes pushed
+
+  void close();
+  void set_error();
+
+  bool is_closed() const;
+  uint64_t available_capacity() const;
+  uint64_t bytes_pushed() const;
+
+  void ack_writable_event(); // Consume a writable_event() wakeup
+};
+
+// Consumer side: call only from the consumer thread
+class SPSCReader : public SPSCByteStream
+{
+public:
+  std::string_view peek() const;                  // Next contiguous bytes (up to the ring wrap point)
+  std::vector<std::string_view> peek_iov() const; // All buffered bytes, as at most two regions
+  void pop( uint64_t len );
+
+  bool is_finished() const;
+  bool has_error() const;
+
+  uint64_t bytes_buffered() const;
+  uint64_t bytes_popped() const;
+
+  void ack_readable_event(); // Consume a readable_event() wakeup
+};
@@ -3,6 +3,7 @@
 #include "address.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
@@ -13,13 +14,53 @@ class TCPConfig
 public:
   static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
   static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
+  static constexpr size_t DEFAULT_PEER_MSS = 536;   //!< MSS assumed when the peer's SYN has no MSS option
+  static constexpr size_t MIN_PEER_MSS = 88;        //!< Smaller MSS options are raised to this (as in Linux)
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr unsigned DUP_ACK_THRESHOLD = 3;  //!< Duplicate ACKs that trigger a fast retransmit
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;   //!< Largest window scale shift (RFC 7323 2.3)
+
+  //! Congestion control algorithm for the TCPSender
+  enum class CongestionControl : uint8_t
+  {
+    None,    //!< Limited by the receiver's window only
+    Reno,    //!< RFC 5681
+    NewReno, //!< RFC 6582
+    Cubic    //!< RFC 9438
+  };
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
-  size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
+  bool adaptive_rto = false;               //!< Derive the timeout from measured round-trip times (RFC 6298)
+  uint16_t rto_min = 200;                  //!< Lower bound of the adaptive timeout, in milliseconds
+  uint16_t rto_max = 60000;                //!< Upper bound of the adaptive timeout (and its backoff), in milliseconds
+  size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes (the initial one, with auto-tuning)
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
+  size_t mss = MAX_PAYLOAD_SIZE;           //!< Largest payload to send or receive (MSS option): MTU - 40
   std::optional<Wrap32> fixed_isn {};
+  CongestionControl congestion_control = CongestionControl::None; //!< Congestion control algorithm
+  bool sack = true; //!< Offer selective acknowledgments (RFC 2018); used if the peer offers them too
+  bool window_scaling = true; //!< Offer window scaling (RFC 7323); used if the peer offers it too
+  bool timestamps = true;     //!< Send timestamps (RFC 7323); used if the peer sends them too
+  bool mtu_probing = false;   //!< Start at MAX_PAYLOAD_SIZE and probe up to the MSS (PLPMTUD, RFC 8899)
+  bool pacing = false;        //!< Spread segments out over time instead of sending each window as a burst
+  uint64_t pacing_rate = 0;   //!< Pacing rate in bytes per second (0: derived from cwnd / SRTT)
+  bool delayed_ack = true;    //!< ACK every second in-order data segment, or after delayed_ack_timeout
+  uint16_t delayed_ack_timeout = 40; //!< Longest an ACK is held back, in milliseconds (RFC 5681 allows 500)
+  bool recv_autotuning = false;       //!< Grow the receive capacity to what the application reads per RTT
+  size_t recv_capacity_max = 4 << 20; //!< Ceiling of the auto-tuned receive capacity, in bytes
+
+  //! Window scale to offer: the smallest shift that lets the 16-bit window field cover recv_capacity
+  //! (or, with auto-tuning, as far as it may grow)
+  uint8_t window_scale() const
+  {
+    const size_t capacity = recv_autotuning ? std::max( recv_capacity, recv_capacity_max ) : recv_capacity;
+    uint8_t shift = 0;
+    while ( shift < MAX_WINDOW_SCALE and ( capacity >> shift ) > UINT16_MAX ) {
+      ++shift;
+    }
+    return shift;
+  }
 };
 
 //! Config for classes derived from FdAdapter
@@ -31,4 +72,7 @@ public:
 
   uint16_t loss_rate_dn = 0; //!< Downlink loss rate (for LossyFdAdapter)
   uint16_t loss_rate_up = 0; //!< Uplink loss rate (for LossyFdAdapter)
+
+  uint64_t bottleneck_rate = 0; //!< Uplink bottleneck rate in bytes per second (for LossyFdAdapter; 0: none)
+  size_t bottleneck_queue = 16; //!< Segments the bottleneck can hold before it drops (for LossyFdAdapter)
 };
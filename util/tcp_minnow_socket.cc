@@ -33,7 +33,12 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const function<bool()>& condition )
 {
   auto base_time = timestamp_ms();
   while ( condition() ) {
-    auto ret = _eventloop.wait_next_event( TCP_TICK_MS );
+    // wake up at least every TCP_TICK_MS, and sooner if the TCPPeer has a deadline (RTO, pacing) before that
+    size_t timeout_ms = TCP_TICK_MS;
+    if ( _tcp.has_value() ) {
+      timeout_ms = min<size_t>( timeout_ms, _tcp->next_deadline().value_or( TCP_TICK_MS ) );
+    }
+    auto ret = _eventloop.wait_next_event( static_cast<int>( timeout_ms ) );
     if ( ret == EventLoop::Result::Exit or _abort ) {
       break;
     }
@@ -152,8 +157,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       // the pipe, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        const auto bytes_written = _thread_data.write( inbound.peek_iov() );
         inbound.pop( bytes_written );
       }
 
@@ -297,6 +301,11 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
     if ( not _tcp.value().active() ) {
       cerr << "DEBUG: TCP connection finished "
            << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
+      if constexpr ( requires { _datagram_adapter.bottleneck_drops(); } ) {
+        if ( _datagram_adapter.config().bottleneck_rate != 0 ) {
+          cerr << "DEBUG: " << _datagram_adapter.bottleneck_drops() << " segments dropped at the bottleneck.\n";
+        }
+      }
     }
     _tcp.reset();
   } catch ( const exception& e ) {
@@ -367,6 +376,8 @@ void FullStackSocket::connect( const Address& address )
 {
   TCPConfig tcp_config;
   tcp_config.rt_timeout = 100;
+  tcp_config.mss = NetworkInterface::DEFAULT_MTU - 40; // room for the IPv4 and TCP headers
+  tcp_config.mtu_probing = true;                       // in case a hop on the path has a smaller MTU
 
   FdAdapterConfig multiplexer_config;
   multiplexer_config.source = { LOCAL_TAP_IP_ADDRESS, to_string( uint16_t( random_device()() ) ) };
@@ -7,27 +7,123 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
 #include <optional>
 
 class TCPPeer
 {
   TCPConfig cfg_;
-  TCPSender sender_ { cfg_.rt_timeout, cfg_.fixed_isn };
+  TCPSender sender_ { cfg_ };
   TCPReceiver receiver_ {};
   Reassembler reassembler_ {};
 
-  ByteStream outbound_stream_ { cfg_.send_capacity }, inbound_stream_ { cfg_.recv_capacity };
+  // Outbound chunks are kept as written, so the sender's payloads can be slices of them (see read( Buffer& ))
+  ByteStream outbound_stream_ { cfg_.send_capacity, ByteStream::Storage::Chunked };
+  ByteStream inbound_stream_ { cfg_.recv_capacity };
 
   bool need_send_ {};
 
+  // Delayed ACKs (RFC 5681 4.2): in-order data is acknowledged every second segment, or once the
+  // delayed-ACK timer expires, unless a segment we send first carries the ACK anyway
+  static constexpr uint64_t DELAYED_ACK_SEGMENTS = 2;
+  uint64_t unacked_segments_ {};            // in-order data segments received since we last sent an ACK
+  std::optional<uint64_t> ack_timer_ms_ {}; // milliseconds until the held-back ACK has to go out
+
+  // Receive-buffer auto-tuning (dynamic right-sizing, as Linux's tcp_rcv_space_adjust): once per round trip,
+  // the inbound capacity grows to twice what the application read in the last one (up to recv_capacity_max),
+  // so the window keeps ahead of a reader that keeps up and stays small for one that doesn't. A connection
+  // that has received nothing for RECV_IDLE_MS gives the memory back, shrinking to recv_capacity.
+  static constexpr uint64_t RECV_IDLE_MS = 1000;
+  uint64_t now_ms_ {};              // time passed in tick()
+  uint64_t recv_rtt_ms_ {};         // RTT measured from the timestamps the peer echoes with its data (0: none)
+  uint64_t recv_round_start_ms_ {}; // when the current measurement round started
+  uint64_t recv_round_popped_ {};   // inbound bytes popped when it started
+  uint64_t last_data_ms_ {};        // when data last arrived
+
+  void tune_receive_buffer()
+  {
+    Writer& inbound = inbound_stream_.writer();
+    const uint64_t popped = inbound_stream_.reader().bytes_popped();
+    if ( inbound.capacity() > cfg_.recv_capacity and now_ms_ - last_data_ms_ >= RECV_IDLE_MS
+         and reassembler_.bytes_pending() == 0 ) {
+      // This takes back window the peer was offered, but it has not used it for a second; anything it
+      // sends past the new edge is dropped (and retransmitted) like any segment outside the window.
+      inbound.set_capacity( cfg_.recv_capacity ); // 空闲：缩回 (仍然装得下还没读的字节)
+    }
+
+    // 没有时间戳就用我们自己发送数据测得的 RTT；两者都没有就没法按往返来算
+    const uint64_t rtt = recv_rtt_ms_ > 0 ? recv_rtt_ms_ : sender_.smoothed_rtt();
+    if ( rtt == 0 or now_ms_ - recv_round_start_ms_ < rtt ) {
+      return;
+    }
+    const uint64_t target = std::min<uint64_t>( 2 * ( popped - recv_round_popped_ ), cfg_.recv_capacity_max );
+    if ( target > inbound.capacity() ) {
+      inbound.set_capacity( target );
+    }
+    recv_round_start_ms_ = now_ms_;
+    recv_round_popped_ = popped;
+  }
+
+  bool peer_sack_permitted_ {}; // the peer's SYN offered SACK
+  std::optional<uint8_t> peer_window_scale_ {}; // the peer's SYN offered window scaling, with this shift
+  bool peer_timestamps_ {};                     // the peer's SYN carried a timestamp
+
+  static constexpr size_t TIMESTAMPS_OPTION_LENGTH = 12; // with its padding
+  size_t segment_limit_ { TCPConfig::DEFAULT_PEER_MSS };  // payload and options of a segment fit in this
+
+  bool use_sack() const { return cfg_.sack and peer_sack_permitted_; }
+
+  // Payload and option bytes of a segment after the handshake (timestamps and SACK)
+  static size_t segment_length( const TCPSegment& seg )
+  {
+    const size_t sack = seg.receiver_message.sack.empty() ? 0 : 2 + 8 * seg.receiver_message.sack.size();
+    const size_t options = ( seg.sender_message.timestamp ? TIMESTAMPS_OPTION_LENGTH : 0 ) + ( sack + 3 ) / 4 * 4;
+    return seg.sender_message.payload.size() + options;
+  }
+  bool use_window_scale() const { return cfg_.window_scaling and peer_window_scale_.has_value(); }
+  bool use_timestamps() const { return cfg_.timestamps and peer_timestamps_; }
+
 public:
   explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg ) {}
 
+  // The sender keeps a pointer to outbound_stream_ (whose retained bytes it retransmits), so a copied or
+  // moved TCPPeer would have its sender reading the original's stream
+  TCPPeer( const TCPPeer& other ) = delete;
+  TCPPeer& operator=( const TCPPeer& other ) = delete;
+  TCPPeer( TCPPeer&& other ) = delete;
+  TCPPeer& operator=( TCPPeer&& other ) = delete;
+  ~TCPPeer() = default;
+
   Writer& outbound_writer() { return outbound_stream_.writer(); }
   Reader& inbound_reader() { return inbound_stream_.reader(); }
 
   void push() { sender_.push( outbound_stream_.reader() ); };
-  void tick( uint64_t ms_since_last_tick ) { sender_.tick( ms_since_last_tick ); }
+  void tick( uint64_t ms_since_last_tick )
+  {
+    now_ms_ += ms_since_last_tick;
+    sender_.tick( ms_since_last_tick );
+    if ( cfg_.recv_autotuning ) {
+      tune_receive_buffer();
+    }
+    if ( ack_timer_ms_.has_value() ) {
+      if ( ms_since_last_tick >= *ack_timer_ms_ ) {
+        need_send_ = true;
+        ack_timer_ms_.reset();
+      } else {
+        *ack_timer_ms_ -= ms_since_last_tick;
+      }
+    }
+  }
+
+  // Milliseconds until tick() next has something to do (see TCPSender::next_deadline), delayed ACKs included
+  std::optional<uint64_t> next_deadline() const
+  {
+    auto deadline = sender_.next_deadline();
+    if ( ack_timer_ms_.has_value() ) {
+      deadline = std::min( deadline.value_or( UINT64_MAX ), *ack_timer_ms_ );
+    }
+    return deadline;
+  }
 
   bool has_ackno() const { return receiver_.send( inbound_stream_.writer() ).ackno.has_value(); }
 
@@ -47,13 +143,56 @@ public:
       return;
     }
 
-    // Give incoming TCPReceiverMessage to sender.
-    sender_.receive( seg.receiver_message );
+    if ( seg.sender_message.SYN ) {
+      peer_sack_permitted_ = seg.sack_permitted;
+      peer_window_scale_ = seg.window_scale;
+      peer_timestamps_ = seg.sender_message.timestamp.has_value();
+
+      // Segments are limited by both MSS options, less the room the timestamps option takes (RFC 6691).
+      // A nonsensically small MSS is raised, so that there is room for the options at all.
+      const size_t peer_mss
+        = std::max<size_t>( seg.mss.value_or( TCPConfig::DEFAULT_PEER_MSS ), TCPConfig::MIN_PEER_MSS );
+      segment_limit_ = std::min( cfg_.mss, peer_mss );
+      sender_.set_mss( segment_limit_ - ( use_timestamps() ? TIMESTAMPS_OPTION_LENGTH : 0 ) );
+    }
+    if ( not use_sack() ) {
+      seg.receiver_message.sack.clear();
+    }
+    if ( not use_timestamps() ) {
+      seg.sender_message.timestamp.reset();
+      seg.receiver_message.timestamp_echo.reset();
+    }
+
+    // The window in a SYN is never scaled (RFC 7323 2.2)
+    sender_.set_window_scale( use_window_scale() and not seg.sender_message.SYN ? *peer_window_scale_ : 0 );
+
+    // Give incoming TCPReceiverMessage to sender (an ACK riding on data is never a duplicate ACK).
+    sender_.receive( seg.receiver_message, seg.sender_message.sequence_length() == 0 );
+
+    // A timestamp echoed with data is one we sent with an ACK a round trip ago (RFC 7323 4.1)
+    if ( seg.sender_message.sequence_length() > 0 ) {
+      last_data_ms_ = now_ms_;
+      if ( seg.receiver_message.timestamp_echo.has_value() ) {
+        const uint64_t sample
+          = std::max<uint32_t>( static_cast<uint32_t>( now_ms_ ) - *seg.receiver_message.timestamp_echo, 1 );
+        recv_rtt_ms_ = recv_rtt_ms_ == 0 ? sample : ( 7 * recv_rtt_ms_ + sample ) / 8;
+      }
+    }
 
     // Give incoming TCPSenderMessage to receiver.
-    // If SenderMessage is non-empty or a keep-alive, make sure to reply.
-    need_send_ |= ( seg.sender_message.sequence_length() > 0 );
+    // If SenderMessage is non-empty or a keep-alive, make sure to reply: right away for a SYN, a FIN, data out
+    // of order or filling a hole (so the sender learns of losses quickly), else possibly after a delay.
     const auto our_ackno = receiver_.send( inbound_stream_.writer() ).ackno;
+    if ( seg.sender_message.sequence_length() > 0 ) {
+      const bool in_order = our_ackno.has_value() and seg.sender_message.seqno == our_ackno.value()
+                            and reassembler_.bytes_pending() == 0;
+      if ( not cfg_.delayed_ack or seg.sender_message.SYN or seg.sender_message.FIN or not in_order
+           or ++unacked_segments_ >= DELAYED_ACK_SEGMENTS ) {
+        need_send_ = true;
+      } else if ( not ack_timer_ms_.has_value() ) {
+        ack_timer_ms_ = cfg_.delayed_ack_timeout;
+      }
+    }
     need_send_ |= ( our_ackno.has_value() and seg.sender_message.seqno + 1 == our_ackno.value() );
 
     receiver_.receive( std::move( seg.sender_message ), reassembler_, inbound_stream_.writer() );
@@ -61,11 +200,8 @@ public:
 
   std::optional<TCPSegment> maybe_send()
   {
-    // Get outgoing TCPReceiverMessage from receiver.
-    auto receiver_msg = receiver_.send( inbound_stream_.writer() );
-
     // If connection is alive, push stream to TCPSender.
-    if ( receiver_msg.ackno.has_value() ) {
+    if ( has_ackno() ) {
       push();
     }
 
@@ -80,8 +216,34 @@ public:
 
     // Send the segment
     if ( sender_msg.has_value() ) {
-      return TCPSegment {
+      // it carries the ACK, so nothing is held back any more
+      unacked_segments_ = 0;
+      ack_timer_ms_.reset();
+
+      // Get outgoing TCPReceiverMessage from receiver, its window scaled unless it rides on our SYN.
+      receiver_.set_window_scale( use_window_scale() and not sender_msg->SYN ? cfg_.window_scale() : 0 );
+      auto receiver_msg = use_sack() ? receiver_.send( inbound_stream_.writer(), reassembler_ )
+                                     : receiver_.send( inbound_stream_.writer() );
+
+      TCPSegment seg {
         sender_msg.value(), receiver_msg, outbound_stream_.reader().has_error() or inbound_reader().has_error() };
+      seg.sack_permitted = sender_msg->SYN and cfg_.sack;
+      if ( sender_msg->SYN ) {
+        seg.mss = static_cast<uint16_t>( std::min<size_t>( cfg_.mss, UINT16_MAX ) );
+      }
+      // A SYN-ACK only offers window scaling or timestamps back if the peer's SYN did
+      if ( sender_msg->SYN and cfg_.window_scaling and ( not receiver_msg.ackno or peer_window_scale_ ) ) {
+        seg.window_scale = cfg_.window_scale();
+      }
+      if ( not use_timestamps() and not( sender_msg->SYN and not receiver_msg.ackno ) ) {
+        seg.sender_message.timestamp.reset();
+        seg.receiver_message.timestamp_echo.reset();
+      }
+      // SACK blocks only go where they fit: a full-size segment carries none (RFC 6691)
+      while ( not seg.receiver_message.sack.empty() and segment_length( seg ) > segment_limit_ ) {
+        seg.receiver_message.sack.pop_back();
+      }
+      return seg;
     }
 
     return {};
@@ -91,4 +253,5 @@ public:
   const TCPReceiver& receiver() const { return receiver_; }
   const TCPSender& sender() const { return sender_; }
   const Reassembler& reassembler() const { return reassembler_; }
+  uint64_t recv_capacity() const { return inbound_stream_.capacity(); } // inbound memory, with auto-tuning
 };
@@ -2,12 +2,14 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
 #include <optional>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains two fields:
+ * It contains four fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
@@ -15,10 +17,26 @@
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
  *    the <cstdint> header).
+ *
+ * 3) Selective acknowledgments (RFC 2018): blocks of sequence numbers beyond the ackno that the
+ *    receiver already holds, each [left, right). Empty unless both sides agreed to use SACK.
+ *
+ * 4) The timestamp echo (RFC 7323 TSecr): the timestamp of the latest in-order segment from the sender,
+ *    so the sender can measure the RTT from any ACK. Empty unless both sides agreed to use timestamps.
  */
 
+struct SackBlock
+{
+  Wrap32 left;
+  Wrap32 right;
+};
+
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4; // as many as fit in the TCP options
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  std::vector<SackBlock> sack {};
+  std::optional<uint32_t> timestamp_echo {};
 };
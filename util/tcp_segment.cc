@@ -1,13 +1,222 @@
 #include "tcp_segment.hh"
 #include "checksum.hh"
+#include "header_layout.hh"
+#include "tcp_config.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
+#include <string>
 
-static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
+static constexpr uint32_t TCPHeaderMinLen = 5;   // 32-bit words
+static constexpr uint32_t TCPOptionsMaxLen = 40; // bytes
+
+// TCP option kinds
+static constexpr uint8_t TCPOptionEnd = 0;
+static constexpr uint8_t TCPOptionNop = 1;
+static constexpr uint8_t TCPOptionMss = 2;
+static constexpr uint8_t TCPOptionWindowScale = 3;
+static constexpr uint8_t TCPOptionSackPermitted = 4;
+static constexpr uint8_t TCPOptionSack = 5;
+static constexpr uint8_t TCPOptionTimestamps = 8;
 
 using namespace std;
 
+class Wrap32Serializable : public Wrap32
+{
+public:
+  uint32_t raw_value() const { return raw_value_; }
+};
+
+namespace {
+
+// The fixed part of the TCP header, as it is on the wire
+struct TCPHeaderFields
+{
+  uint16_t src_port {};
+  uint16_t dst_port {};
+  uint32_t seqno {};
+  uint32_t ackno {};
+  uint8_t data_offset {}; // header length, in 32-bit words
+  bool ack {};
+  bool rst {};
+  bool syn {};
+  bool fin {};
+  uint16_t window_size {};
+  uint16_t cksum {};
+};
+
+using Layout = HeaderLayout<HeaderField<&TCPHeaderFields::src_port, 0, 16>,
+                            HeaderField<&TCPHeaderFields::dst_port, 16, 16>,
+                            HeaderField<&TCPHeaderFields::seqno, 32, 32>,
+                            HeaderField<&TCPHeaderFields::ackno, 64, 32>,
+                            HeaderField<&TCPHeaderFields::data_offset, 96, 4>,
+                            HeaderReserved<100, 7>, // reserved, CWR, ECE and URG
+                            HeaderField<&TCPHeaderFields::ack, 107, 1>,
+                            HeaderReserved<108, 1>, // PSH
+                            HeaderField<&TCPHeaderFields::rst, 109, 1>,
+                            HeaderField<&TCPHeaderFields::syn, 110, 1>,
+                            HeaderField<&TCPHeaderFields::fin, 111, 1>,
+                            HeaderField<&TCPHeaderFields::window_size, 112, 16>,
+                            HeaderField<&TCPHeaderFields::cksum, 128, 16>,
+                            HeaderReserved<144, 16>>; // urgent pointer
+
+static_assert( Layout::LENGTH == TCPHeaderMinLen * 4 );
+
+} // namespace
+
+// The TCP options as bytes, padded to a multiple of 4 bytes
+static string serialize_options( const TCPSegment& seg )
+{
+  Serializer options;
+  uint32_t length = 0;
+
+  if ( seg.mss.has_value() ) {
+    options.integer( TCPOptionMss );
+    options.integer( uint8_t { 4 } );
+    options.integer( seg.mss.value() );
+    length += 4;
+  }
+
+  if ( seg.window_scale.has_value() ) { // NOP 对齐到 4 字节
+    options.integer( TCPOptionNop );
+    options.integer( TCPOptionWindowScale );
+    options.integer( uint8_t { 3 } );
+    options.integer( seg.window_scale.value() );
+    length += 4;
+  }
+
+  if ( seg.sender_message.timestamp.has_value() ) { // 两个 NOP 对齐到 4 字节
+    options.integer( TCPOptionNop );
+    options.integer( TCPOptionNop );
+    options.integer( TCPOptionTimestamps );
+    options.integer( uint8_t { 10 } );
+    options.integer( seg.sender_message.timestamp.value() );
+    options.integer( seg.receiver_message.timestamp_echo.value_or( 0 ) ); // TSecr 只在有 ACK 时有意义
+    length += 12;
+  }
+
+  if ( seg.sack_permitted ) {
+    options.integer( TCPOptionSackPermitted );
+    options.integer( uint8_t { 2 } );
+    length += 2;
+  }
+
+  // as many SACK blocks as fit in the remaining option space
+  const size_t sack_blocks
+    = min( seg.receiver_message.sack.size(), static_cast<size_t>( ( TCPOptionsMaxLen - length - 2 ) / 8 ) );
+  if ( sack_blocks > 0 ) {
+    options.integer( TCPOptionSack );
+    options.integer( static_cast<uint8_t>( 2 + 8 * sack_blocks ) );
+    for ( size_t i = 0; i < sack_blocks; ++i ) {
+      options.integer( Wrap32Serializable { seg.receiver_message.sack[i].left }.raw_value() );
+      options.integer( Wrap32Serializable { seg.receiver_message.sack[i].right }.raw_value() );
+    }
+    length += 2 + 8 * sack_blocks;
+  }
+
+  for ( ; length % 4; ++length ) {
+    options.integer( TCPOptionEnd );
+  }
+
+  string ret;
+  for ( const auto& buf : options.output() ) {
+    ret.append( buf );
+  }
+  return ret;
+}
+
+// Parse `length` bytes of TCP options; unknown options are skipped
+static void parse_options( Parser& parser, uint32_t length, TCPSegment& seg )
+{
+  uint8_t kind {};
+  uint8_t option_length {};
+  uint32_t raw32 {};
+
+  while ( length > 0 and not parser.has_error() ) {
+    parser.integer( kind );
+    --length;
+    if ( kind == TCPOptionEnd ) {
+      break;
+    }
+    if ( kind == TCPOptionNop ) {
+      continue;
+    }
+
+    parser.integer( option_length );
+    if ( option_length < 2 or option_length - 1U > length ) {
+      parser.set_error();
+      return;
+    }
+    length -= option_length - 1;
+
+    switch ( kind ) {
+      case TCPOptionMss: {
+        if ( option_length != 4 ) {
+          parser.set_error();
+          return;
+        }
+        uint16_t mss {};
+        parser.integer( mss );
+        seg.mss = mss;
+        break;
+      }
+
+      case TCPOptionWindowScale: {
+        if ( option_length != 3 ) {
+          parser.set_error();
+          return;
+        }
+        uint8_t shift {};
+        parser.integer( shift );
+        seg.window_scale = min( shift, TCPConfig::MAX_WINDOW_SCALE ); // RFC 7323 2.3: larger shifts mean 14
+        break;
+      }
+
+      case TCPOptionSackPermitted:
+        seg.sack_permitted = true;
+        parser.remove_prefix( option_length - 2 );
+        break;
+
+      case TCPOptionSack:
+        if ( ( option_length - 2 ) % 8 ) {
+          parser.set_error();
+          return;
+        }
+        for ( uint8_t i = 0; i < ( option_length - 2 ) / 8; ++i ) {
+          SackBlock block { Wrap32 { 0 }, Wrap32 { 0 } };
+          parser.integer( raw32 );
+          block.left = Wrap32 { raw32 };
+          parser.integer( raw32 );
+          block.right = Wrap32 { raw32 };
+          seg.receiver_message.sack.push_back( block );
+        }
+        break;
+
+      case TCPOptionTimestamps: {
+        if ( option_length != 10 ) {
+          parser.set_error();
+          return;
+        }
+        uint32_t tsval {};
+        uint32_t tsecr {};
+        parser.integer( tsval );
+        parser.integer( tsecr );
+        seg.sender_message.timestamp = tsval;
+        if ( seg.receiver_message.ackno.has_value() ) { // RFC 7323 3.2: TSecr is only valid with ACK
+          seg.receiver_message.timestamp_echo = tsecr;
+        }
+        break;
+      }
+
+      default:
+        parser.remove_prefix( option_length - 2 );
+    }
+  }
+
+  parser.remove_prefix( length ); // padding after the end-of-options
+}
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   {
@@ -23,73 +232,73 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
     }
   }
 
-  uint32_t raw32 {};
-  uint16_t raw16 {};
-  uint8_t octet {};
-
-  parser.integer( udinfo.src_port );
-  parser.integer( udinfo.dst_port );
-
-  parser.integer( raw32 );
-  sender_message.seqno = Wrap32 { raw32 };
-
-  parser.integer( raw32 );
-  receiver_message.ackno = Wrap32 { raw32 };
-
-  parser.integer( octet );
-  const uint8_t data_offset = octet >> 4;
-
-  parser.integer( octet ); // flags
-  if ( not( octet & 0b0001'0000 ) ) {
-    receiver_message.ackno.reset(); // no ACK
+  TCPHeaderFields fields;
+  Layout::parse( fields, parser );
+  if ( parser.has_error() ) {
+    return;
   }
 
-  reset = octet & 0b0000'0100;
-  sender_message.SYN = octet & 0b0000'0010;
-  sender_message.FIN = octet & 0b0000'0001;
-
-  parser.integer( receiver_message.window_size );
-  parser.integer( udinfo.cksum );
-  parser.integer( raw16 ); // urgent pointer
+  udinfo.src_port = fields.src_port;
+  udinfo.dst_port = fields.dst_port;
+  udinfo.cksum = fields.cksum;
+  sender_message.seqno = Wrap32 { fields.seqno };
+  sender_message.SYN = fields.syn;
+  sender_message.FIN = fields.fin;
+  reset = fields.rst;
+  receiver_message.window_size = fields.window_size;
+  if ( fields.ack ) {
+    receiver_message.ackno = Wrap32 { fields.ackno };
+  } else {
+    receiver_message.ackno.reset();
+  }
 
-  // skip any options or anything extra in the header
-  if ( data_offset < TCPHeaderMinLen ) {
+  if ( fields.data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( parser, fields.data_offset * 4 - TCPHeaderMinLen * 4, *this );
 
   parser.all_remaining( sender_message.payload );
 }
 
-class Wrap32Serializable : public Wrap32
-{
-public:
-  uint32_t raw_value() const { return raw_value_; }
-};
-
 void TCPSegment::serialize( Serializer& serializer ) const
 {
-  serializer.integer( udinfo.src_port );
-  serializer.integer( udinfo.dst_port );
-  serializer.integer( Wrap32Serializable { sender_message.seqno }.raw_value() );
-  serializer.integer( Wrap32Serializable { receiver_message.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
-  const uint8_t flags = ( receiver_message.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
-                        | ( sender_message.SYN ? 0b0000'0010U : 0 ) | ( sender_message.FIN ? 0b0000'0001U : 0 );
-  serializer.integer( flags );
-  serializer.integer( receiver_message.window_size );
-  serializer.integer( udinfo.cksum );
-  serializer.integer( uint16_t { 0 } ); // urgent pointer
+  serialize_header( serializer );
   serializer.buffer( sender_message.payload );
 }
 
+void TCPSegment::serialize_header( Serializer& serializer ) const
+{
+  const string options = serialize_options( *this );
+  TCPHeaderFields fields;
+  fields.src_port = udinfo.src_port;
+  fields.dst_port = udinfo.dst_port;
+  fields.seqno = Wrap32Serializable { sender_message.seqno }.raw_value();
+  fields.ackno = Wrap32Serializable { receiver_message.ackno.value_or( Wrap32 { 0 } ) }.raw_value();
+  fields.data_offset = static_cast<uint8_t>( TCPHeaderMinLen + options.size() / 4 );
+  fields.ack = receiver_message.ackno.has_value();
+  fields.rst = reset;
+  fields.syn = sender_message.SYN;
+  fields.fin = sender_message.FIN;
+  fields.window_size = receiver_message.window_size;
+  fields.cksum = udinfo.cksum;
+  Layout::serialize( fields, serializer );
+  serializer.string( options );
+}
+
 void TCPSegment::compute_checksum( uint32_t datagram_layer_pseudo_checksum )
 {
   udinfo.cksum = 0;
   Serializer s;
-  serialize( s );
+  serialize_header( s );
 
   InternetChecksum check { datagram_layer_pseudo_checksum };
   check.add( s.output() );
+  // the payload follows the (4-byte aligned) header; its sum is known if the sender summed it as it copied it
+  if ( sender_message.payload_sum.has_value() ) {
+    check.add_sum( *sender_message.payload_sum );
+  } else {
+    check.add( sender_message.payload );
+  }
   udinfo.cksum = check.value();
 }
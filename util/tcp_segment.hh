@@ -5,15 +5,22 @@
 #include "tcp_sender_message.hh"
 #include "udinfo.hh"
 
+#include <optional>
+
 struct TCPSegment
 {
   TCPSenderMessage sender_message {};
   TCPReceiverMessage receiver_message {};
   bool reset {}; // Connection experienced an abnormal error and should be shut down
   UserDatagramInfo udinfo {};
+  std::optional<uint16_t> mss {}; // MSS option (on a SYN): the largest payload this side can receive
+  bool sack_permitted {};         // SACK-permitted option (on a SYN): this side can receive SACK blocks
+  std::optional<uint8_t> window_scale {}; // Window scale option (on a SYN): shift of this side's later windows
 
   void parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
   void serialize( Serializer& serializer ) const;
+  void serialize_header( Serializer& serializer ) const; // everything but the payload
 
+  // Uses sender_message.payload_sum, if set, instead of reading the payload again
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
 };
@@ -3,12 +3,14 @@
 #include "buffer.hh"
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
  *
- * It contains four fields:
+ * It contains five fields:
  *
  * 1) The sequence number (seqno) of the beginning of the segment. If the SYN flag is set, this is the
  *    sequence number of the SYN flag. Otherwise, it's the sequence number of the beginning of the payload.
@@ -19,6 +21,13 @@
  * 3) The payload: a substring (possibly empty) of the byte stream.
  *
  * 4) The FIN flag. If set, it means the payload represents the ending of the byte stream.
+ *
+ * 5) The timestamp (RFC 7323 TSval): the sender's clock, in milliseconds, when the segment was sent.
+ *    Empty unless both sides agreed to use timestamps.
+ *
+ * The TCPSender also records the payload's InternetChecksum::partial_sum, which it computes as it copies
+ * the payload out of the stream, so the segment's checksum doesn't read the payload again. Anything that
+ * changes the payload afterwards has to reset it.
  */
 
 struct TCPSenderMessage
@@ -27,6 +36,8 @@ struct TCPSenderMessage
   bool SYN { false };
   Buffer payload {};
   bool FIN { false };
+  std::optional<uint32_t> timestamp {};
+  std::optional<uint16_t> payload_sum {}; // partial Internet checksum of the payload, if known
 
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// A hierarchical timer wheel (Varghese and Lauck, as in the Linux kernel): four levels of 256 slots,
+// each slot of a level spanning a whole turn of the level below. Arming and cancelling a timer are O(1),
+// and advance() jumps from one occupied slot (or cascade) to the next, so it only touches the timers
+// that expire, plus each timer once per level it moves down, and at most a turn of the lowest level
+// of empty slots between them.
+//
+// Callbacks are given the arguments passed to advance(). An object that keeps its own wheel can pass
+// itself there (TimerWheel<Owner&>), so a copy of the object does not hold callbacks into the original.
+template<typename... Args>
+class TimerWheel
+{
+public:
+  using Callback = std::function<void( Args... )>;
+
+  // Names an armed timer; it goes stale once the timer fires or is cancelled
+  struct Id
+  {
+    uint32_t index { UINT32_MAX };
+    uint32_t generation { 0 };
+  };
+
+  // Call `callback` once `delay_ms` milliseconds have passed (a delay of 0 fires on the next advance)
+  Id schedule( uint64_t delay_ms, Callback callback );
+
+  // Disarm a timer. Returns false if it already fired or was cancelled.
+  bool cancel( Id id );
+
+  bool pending( Id id ) const
+  {
+    return id.index < nodes_.size() and nodes_[id.index].generation == id.generation
+           and nodes_[id.index].list != NIL;
+  }
+
+  // Let `ms` milliseconds pass, calling each expired timer's callback in deadline order.
+  // Callbacks may schedule and cancel timers, including ones that expire in the same advance().
+  void advance( uint64_t ms, Args... args );
+
+  uint64_t now() const { return now_ms_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+private:
+  static constexpr unsigned LEVELS = 4;
+  static constexpr unsigned SLOT_BITS = 8;
+  static constexpr uint32_t SLOTS = 1U << SLOT_BITS;
+  static constexpr uint64_t MAX_DELAY = ( uint64_t { 1 } << ( SLOT_BITS * LEVELS ) ) - 1; // further ones wait
+  static constexpr uint32_t NIL = UINT32_MAX;
+  static constexpr uint32_t EXPIRING = LEVELS * SLOTS; // the list of timers being fired
+
+  struct Node
+  {
+    uint64_t deadline {};
+    Callback callback {};
+    uint32_t prev { NIL };
+    uint32_t next { NIL };
+    uint32_t list { NIL }; // slot (or EXPIRING) it is linked into, NIL when free
+    uint32_t generation { 0 };
+  };
+
+  static constexpr std::array<uint32_t, EXPIRING + 1> empty_lists()
+  {
+    std::array<uint32_t, EXPIRING + 1> heads {};
+    heads.fill( NIL );
+    return heads;
+  }
+
+  std::vector<Node> nodes_ {};
+  std::vector<uint32_t> free_ {};
+  std::array<uint32_t, EXPIRING + 1> heads_ { empty_lists() };
+  std::array<size_t, LEVELS> level_size_ {}; // timers on each level
+  uint64_t now_ms_ { 0 };
+  size_t size_ { 0 };
+
+  void link( uint32_t index, uint32_t list );
+  void unlink( uint32_t index );
+  void release( uint32_t index );
+  void insert( uint32_t index ); // into the slot for its deadline
+  uint32_t cascade( unsigned level );
+};
+
+template<typename... Args>
+typename TimerWheel<Args...>::Id TimerWheel<Args...>::schedule( uint64_t delay_ms, Callback callback )
+{
+  uint32_t index {};
+  if ( free_.empty() ) {
+    index = static_cast<uint32_t>( nodes_.size() );
+    nodes_.emplace_back();
+  } else {
+    index = free_.back();
+    free_.pop_back();
+  }
+
+  Node& node = nodes_[index];
+  node.deadline = now_ms_ + std::max<uint64_t>( delay_ms, 1 );
+  node.callback = std::move( callback );
+  insert( index );
+  ++size_;
+  return { index, node.generation };
+}
+
+template<typename... Args>
+bool TimerWheel<Args...>::cancel( Id id )
+{
+  if ( not pending( id ) ) {
+    return false;
+  }
+  unlink( id.index );
+  release( id.index );
+  return true;
+}
+
+template<typename... Args>
+void TimerWheel<Args...>::advance( uint64_t ms, Args... args )
+{
+  const uint64_t target = now_ms_ + ms;
+  while ( now_ms_ < target ) {
+    if ( size_ == 0 ) { // nothing can expire: skip the rest
+      now_ms_ = target;
+      return;
+    }
+
+    // skip the milliseconds in which nothing is due: up to the next occupied slot of the lowest level,
+    // or (if it is empty) up to the next turn of the lowest level that holds timers, where they cascade
+    uint64_t next = 0;
+    if ( level_size_[0] > 0 ) {
+      next = now_ms_ + 1;
+      while ( heads_[next & ( SLOTS - 1 )] == NIL and ( next & ( SLOTS - 1 ) ) != 0 ) {
+        ++next;
+      }
+    } else {
+      unsigned idle = 1;
+      while ( level_size_[idle] == 0 ) {
+        ++idle;
+      }
+      next = ( now_ms_ | ( ( uint64_t { 1 } << ( SLOT_BITS * idle ) ) - 1 ) ) + 1;
+    }
+    if ( next > target ) {
+      now_ms_ = target;
+      return;
+    }
+    now_ms_ = next;
+
+    // at the start of each turn of a level, move the timers of its next slot down a level
+    for ( unsigned level = 1; level < LEVELS; ++level ) {
+      if ( now_ms_ & ( ( uint64_t { 1 } << ( SLOT_BITS * level ) ) - 1 ) or cascade( level ) != 0 ) {
+        break;
+      }
+    }
+
+    // fire this millisecond's slot: move it aside first, so callbacks can arm and cancel freely
+    const uint32_t slot = now_ms_ & ( SLOTS - 1 );
+    while ( heads_[slot] != NIL ) {
+      const uint32_t index = heads_[slot];
+      unlink( index );
+      link( index, EXPIRING );
+    }
+    while ( heads_[EXPIRING] != NIL ) {
+      const uint32_t index = heads_[EXPIRING];
+      unlink( index );
+      Callback callback = std::move( nodes_[index].callback );
+      release( index );
+      callback( args... );
+    }
+  }
+}
+
+template<typename... Args>
+void TimerWheel<Args...>::link( uint32_t index, uint32_t list )
+{
+  Node& node = nodes_[index];
+  if ( list != EXPIRING ) {
+    ++level_size_[list / SLOTS];
+  }
+  node.list = list;
+  node.prev = NIL;
+  node.next = heads_[list];
+  if ( node.next != NIL ) {
+    nodes_[node.next].prev = index;
+  }
+  heads_[list] = index;
+}
+
+template<typename... Args>
+void TimerWheel<Args...>::unlink( uint32_t index )
+{
+  Node& node = nodes_[index];
+  if ( node.list != EXPIRING ) {
+    --level_size_[node.list / SLOTS];
+  }
+  if ( node.prev != NIL ) {
+    nodes_[node.prev].next = node.next;
+  } else {
+    heads_[node.list] = node.next;
+  }
+  if ( node.next != NIL ) {
+    nodes_[node.next].prev = node.prev;
+  }
+  node.prev = node.next = node.list = NIL;
+}
+
+template<typename... Args>
+void TimerWheel<Args...>::release( uint32_t index )
+{
+  Node& node = nodes_[index];
+  node.callback = nullptr;
+  ++node.generation;
+  free_.push_back( index );
+  --size_;
+}
+
+template<typename... Args>
+void TimerWheel<Args...>::insert( uint32_t index )
+{
+  // a deadline further than the wheel reaches waits in the last slot, and is placed again from there
+  const uint64_t delay = std::min( nodes_[index].deadline - now_ms_, MAX_DELAY );
+  const uint64_t deadline = now_ms_ + delay;
+
+  unsigned level = 0;
+  while ( level + 1 < LEVELS and delay >= ( uint64_t { 1 } << ( SLOT_BITS * ( level + 1 ) ) ) ) {
+    ++level;
+  }
+  const uint32_t slot = ( deadline >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 );
+  link( index, level * SLOTS + slot );
+}
+
+// Returns the index of the slot that was cascaded (0 means the level above is due too)
+template<typename... Args>
+uint32_t TimerWheel<Args...>::cascade( unsigned level )
+{
+  const uint32_t slot = ( now_ms_ >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 );
+  const uint32_t list = level * SLOTS + slot;
+  while ( heads_[list] != NIL ) {
+    const uint32_t index = heads_[list];
+    unlink( index );
+    insert( index );
+  }
+  return slot;
+}
@@ -21,12 +21,14 @@ optional<TCPSegment> TCPOverIPv4OverTunFdAdapter::read()
 //! \param[in] eth_address Ethernet address (local address) of the adapter
 //! \param[in] ip_address IP address (local address) of the adapter
 //! \param[in] next_hop IP address of the next hop (typically a router or default gateway)
+//! \param[in] mtu largest IPv4 datagram the interface sends
 TCPOverIPv4OverEthernetAdapter::TCPOverIPv4OverEthernetAdapter(
   TapFD&& tap,
   const EthernetAddress& eth_address,
   const Address& ip_address, // NOLINT(*-easily-swappable-*)
-  const Address& next_hop )
-  : _tap( move( tap ) ), _interface( eth_address, ip_address ), _next_hop( next_hop )
+  const Address& next_hop,
+  size_t mtu )
+  : _tap( move( tap ) ), _interface( eth_address, ip_address, mtu ), _next_hop( next_hop )
 {
   // Linux seems to ignore the first frame sent on a TAP device, so send a dummy frame to prime the pump :-(
   const EthernetFrame dummy_frame;
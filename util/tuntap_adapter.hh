@@ -56,7 +56,8 @@ public:
   explicit TCPOverIPv4OverEthernetAdapter( TapFD&& tap,
                                            const EthernetAddress& eth_address,
                                            const Address& ip_address,
-                                           const Address& next_hop );
+                                           const Address& next_hop,
+                                           size_t mtu = NetworkInterface::DEFAULT_MTU );
   //! Attempts to read and parse an Ethernet frame containing an IPv4 datagram that contains a TCP segment
   std::optional<TCPSegment> read();
 